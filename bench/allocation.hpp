@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <benchmark/benchmark.h>
+
+namespace bench
+{
+
+//counted by the replaced global operator new
+std::size_t allocations() noexcept;
+
+class allocation_counter
+{
+    benchmark::State& m_state;
+    std::size_t m_start;
+public:
+    explicit allocation_counter(benchmark::State& state) noexcept :
+        m_state(state), m_start(allocations())
+    {
+
+    }
+
+    ~allocation_counter()
+    {
+        m_state.counters["allocs"] = benchmark::Counter(
+                    static_cast<double>(allocations() - m_start),
+                    benchmark::Counter::kAvgIterations);
+    }
+};
+
+}
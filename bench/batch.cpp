@@ -0,0 +1,98 @@
+#include <vector>
+
+#include <vv6/func_batch.hpp>
+#include <vv6/func_view.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+struct event
+{
+    long value;
+};
+
+template <int N>
+struct subscriber
+{
+    long m_sum = 0;
+
+    void operator()(const event& e)
+    {
+        m_sum += e.value * N;
+    }
+};
+
+//a few subscriber types, interleaved as they would subscribe over time
+struct subscribers
+{
+    std::vector<subscriber<1>> m_s1;
+    std::vector<subscriber<2>> m_s2;
+    std::vector<subscriber<3>> m_s3;
+    std::vector<subscriber<4>> m_s4;
+
+    explicit subscribers(std::size_t n) :
+        m_s1(n / 4), m_s2(n / 4), m_s3(n / 4), m_s4(n / 4)
+    {
+
+    }
+
+    template <typename F>
+    void for_each(F f)
+    {
+        for(std::size_t i = 0; i < m_s1.size(); ++i)
+        {
+            f(m_s1[i]);
+            f(m_s2[i]);
+            f(m_s3[i]);
+            f(m_s4[i]);
+        }
+    }
+};
+
+void batch_func_views(benchmark::State& state)
+{
+    subscribers subs(state.range(0));
+    std::vector<vv6::func_view<void(const event&)>> views;
+    subs.for_each([&](auto& s) { views.emplace_back(vv6::use_non_const, s); });
+    for(auto _ : state)
+    {
+        event e{1};
+        for(auto& v : views)
+        {
+            v(e);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void batch_grouped_views(benchmark::State& state)
+{
+    subscribers subs(state.range(0));
+    vv6::func_batch<void(const event&)> batch;
+    subs.for_each([&](auto& s) { batch.add(vv6::func_view<void(const event&)>(vv6::use_non_const, s)); });
+    for(auto _ : state)
+    {
+        batch.invoke_all(event{1});
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void batch_typed(benchmark::State& state)
+{
+    subscribers subs(state.range(0));
+    vv6::func_batch<void(const event&)> batch;
+    subs.for_each([&](auto& s) { batch.add(vv6::use_non_const, s); });
+    for(auto _ : state)
+    {
+        batch.invoke_all(event{1});
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(batch_func_views)->Arg(1 << 8)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK(batch_grouped_views)->Arg(1 << 8)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK(batch_typed)->Arg(1 << 8)->Arg(1 << 12)->Arg(1 << 16);
@@ -0,0 +1,798 @@
+#include <array>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <vv6/copy_func.hpp>
+#include <vv6/func_pool.hpp>
+#include <vv6/func_view.hpp>
+#include <vv6/intrusive_func.hpp>
+#include <vv6/shared_func.hpp>
+#include <vv6/unique_func.hpp>
+
+#include "allocation.hpp"
+
+namespace
+{
+
+//P0792 style function_ref, type erasure without the pass_by_value adjustment
+template <typename Sig>
+class function_ref;
+
+template <typename Ret, typename... Args>
+class function_ref<Ret(Args...)>
+{
+    void* m_obj;
+    Ret (*m_call)(void*, Args...);
+public:
+    template <typename T>
+    function_ref(T& obj) noexcept :
+        m_obj(&obj),
+        m_call([](void* o, Args... args) -> Ret
+        {
+            return (*static_cast<T*>(o))(std::forward<Args>(args)...);
+        })
+    {
+
+    }
+
+    Ret operator()(Args... args) const
+    {
+        return m_call(m_obj, std::forward<Args>(args)...);
+    }
+};
+
+template <typename Sig>
+struct virtual_func;
+
+template <typename Ret, typename... Args>
+struct virtual_func<Ret(Args...)>
+{
+    virtual ~virtual_func() = default;
+    virtual Ret operator()(Args... args) const = 0;
+};
+
+template <typename Sig, typename T>
+struct virtual_impl;
+
+template <typename Ret, typename... Args, typename T>
+struct virtual_impl<Ret(Args...), T> final : virtual_func<Ret(Args...)>
+{
+    T m_fn;
+
+    Ret operator()(Args... args) const override
+    {
+        return m_fn(std::forward<Args>(args)...);
+    }
+};
+
+//argument shapes, some of them are passed by value into the trampolines
+
+struct scalar
+{
+    using arg_type = int;
+    using sig = int(arg_type);
+    static arg_type make()
+    {
+        return 1;
+    }
+
+    struct fn
+    {
+        int k = 1;
+        int operator()(int x) const
+        {
+            return x + k;
+        }
+    };
+};
+
+struct two_doubles
+{
+    using arg_type = double;
+    using sig = double(arg_type, arg_type);
+    static arg_type make()
+    {
+        return 1.5;
+    }
+
+    struct fn
+    {
+        double k = 1;
+        double operator()(double x, double y) const
+        {
+            return x * y + k;
+        }
+    };
+};
+
+struct string_view
+{
+    using arg_type = std::string_view;
+    using sig = std::size_t(arg_type);
+    static arg_type make()
+    {
+        return "hello, world";
+    }
+
+    struct fn
+    {
+        std::size_t k = 1;
+        std::size_t operator()(std::string_view s) const
+        {
+            return s.size() + k;
+        }
+    };
+};
+
+struct pair
+{
+    using arg_type = std::pair<long, long>;
+    using sig = long(arg_type);
+    static arg_type make()
+    {
+        return {1, 2};
+    }
+
+    struct fn
+    {
+        long k = 1;
+        long operator()(std::pair<long, long> p) const
+        {
+            return p.first + p.second + k;
+        }
+    };
+};
+
+struct const_string_ref
+{
+    using arg_type = const std::string&;
+    using sig = std::size_t(arg_type);
+    static std::string make()
+    {
+        return "hello, world";
+    }
+
+    struct fn
+    {
+        std::size_t k = 1;
+        std::size_t operator()(const std::string& s) const
+        {
+            return s.size() + k;
+        }
+    };
+};
+
+struct array
+{
+    using arg_type = std::array<int, 8>;
+    using sig = int(arg_type);
+    static arg_type make()
+    {
+        return {1, 2, 3, 4, 5, 6, 7, 8};
+    }
+
+    struct fn
+    {
+        int k = 1;
+        int operator()(const std::array<int, 8>& a) const
+        {
+            return a[0] + a[7] + k;
+        }
+    };
+};
+
+template <typename Shape, typename F, typename Arg>
+decltype(auto) call(F& f, Arg& arg)
+{
+    using A = typename Shape::arg_type;
+    if constexpr(std::is_same_v<Shape, two_doubles>)
+    {
+        return f(static_cast<A>(arg), static_cast<A>(arg));
+    }
+    else
+    {
+        return f(static_cast<A>(arg));
+    }
+}
+
+template <typename Shape, typename F>
+void run_invoke(benchmark::State& state, F& f)
+{
+    auto arg = Shape::make();
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(f);
+        benchmark::DoNotOptimize(arg);
+        benchmark::DoNotOptimize(call<Shape>(f, arg));
+    }
+}
+
+template <typename Shape>
+void invoke_direct(benchmark::State& state)
+{
+    typename Shape::fn fn;
+    run_invoke<Shape>(state, fn);
+}
+
+template <typename Shape>
+void invoke_virtual(benchmark::State& state)
+{
+    std::unique_ptr<const virtual_func<typename Shape::sig>> p =
+            std::make_unique<virtual_impl<typename Shape::sig, typename Shape::fn>>();
+    auto& f = *p;
+    run_invoke<Shape>(state, f);
+}
+
+template <typename Shape>
+void invoke_function_ref(benchmark::State& state)
+{
+    typename Shape::fn fn;
+    function_ref<typename Shape::sig> f(fn);
+    run_invoke<Shape>(state, f);
+}
+
+template <typename Shape>
+void invoke_std_function(benchmark::State& state)
+{
+    std::function<typename Shape::sig> f(typename Shape::fn{});
+    run_invoke<Shape>(state, f);
+}
+
+template <typename Shape>
+void invoke_func_view(benchmark::State& state)
+{
+    typename Shape::fn fn;
+    vv6::func_view<typename Shape::sig> f(fn);
+    run_invoke<Shape>(state, f);
+}
+
+template <typename Shape>
+void invoke_unique_func(benchmark::State& state)
+{
+    vv6::unique_func<typename Shape::sig> f(typename Shape::fn{});
+    run_invoke<Shape>(state, f);
+}
+
+template <typename Shape>
+void invoke_unique_func_vtable(benchmark::State& state)
+{
+    vv6::basic_unique_func<typename Shape::sig, vv6::default_capacity, vv6::default_alignment, vv6::vtable_policy>
+            f(typename Shape::fn{});
+    run_invoke<Shape>(state, f);
+}
+
+struct counted_policy : vv6::default_policy
+{
+    using instrumentation = vv6::counting_instrumentation<>;
+};
+
+template <typename Shape>
+void invoke_unique_func_counted(benchmark::State& state)
+{
+    vv6::basic_unique_func<typename Shape::sig, vv6::default_capacity, vv6::default_alignment, counted_policy>
+            f(typename Shape::fn{});
+    run_invoke<Shape>(state, f);
+}
+
+template <typename Shape>
+void invoke_shared_func(benchmark::State& state)
+{
+    auto f = vv6::make_shared_func<typename Shape::sig>(typename Shape::fn{});
+    run_invoke<Shape>(state, f);
+}
+
+template <typename Shape>
+void invoke_intrusive_func(benchmark::State& state)
+{
+    auto f = vv6::make_intrusive_func<typename Shape::sig>(typename Shape::fn{});
+    run_invoke<Shape>(state, f);
+}
+
+#define VV6_BENCH_INVOKE(shape) \
+    BENCHMARK_TEMPLATE(invoke_direct, shape); \
+    BENCHMARK_TEMPLATE(invoke_virtual, shape); \
+    BENCHMARK_TEMPLATE(invoke_function_ref, shape); \
+    BENCHMARK_TEMPLATE(invoke_std_function, shape); \
+    BENCHMARK_TEMPLATE(invoke_func_view, shape); \
+    BENCHMARK_TEMPLATE(invoke_unique_func, shape); \
+    BENCHMARK_TEMPLATE(invoke_unique_func_vtable, shape); \
+    BENCHMARK_TEMPLATE(invoke_shared_func, shape); \
+    BENCHMARK_TEMPLATE(invoke_intrusive_func, shape)
+
+VV6_BENCH_INVOKE(scalar);
+VV6_BENCH_INVOKE(two_doubles);
+VV6_BENCH_INVOKE(string_view);
+VV6_BENCH_INVOKE(pair);
+VV6_BENCH_INVOKE(const_string_ref);
+VV6_BENCH_INVOKE(array);
+BENCHMARK_TEMPLATE(invoke_unique_func_counted, scalar);
+
+//a func_view as it was with the by value threshold at one pointer, its trampoline takes anything larger by reference
+template <typename T>
+using old_argument_t = std::conditional_t<std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(void*), T, T&&>;
+
+template <typename Sig>
+class ref_view;
+
+template <typename Ret, typename... Args>
+class ref_view<Ret(Args...)>
+{
+    const void* m_obj = nullptr;
+    Ret (*m_call)(const void*, old_argument_t<Args>...) = nullptr;
+public:
+    ref_view() noexcept = default;
+
+    template <typename T>
+    explicit ref_view(const T& obj) noexcept :
+        m_obj(&obj),
+        m_call([](const void* o, old_argument_t<Args>... args) -> Ret
+        {
+            return (*static_cast<const T*>(o))(std::forward<Args>(args)...);
+        })
+    {
+
+    }
+
+    Ret operator()(Args&&... args) const
+    {
+        return m_call(m_obj, std::forward<Args>(args)...);
+    }
+};
+
+//a layer of callbacks, it takes the argument by value as a handler would and calls the next view with it
+template <typename View, typename Arg>
+struct hop
+{
+    const View* m_next;
+
+    decltype(auto) operator()(Arg arg) const
+    {
+        return (*m_next)(static_cast<Arg>(arg));
+    }
+};
+
+//through a view taking it by reference, each hop stores the argument to the stack and the next one loads it.
+//string_view and pair<long, long> stay in two registers through func_view where pass_by_value_size is 16,
+//ref_view is func_view with the old threshold of one pointer. a build with -DVV6_PASS_BY_VALUE_SIZE=8
+//gives that for func_view as well, the two should then be level
+template <template <typename> class View, typename Shape>
+void forward_view(benchmark::State& state)
+{
+    using view = View<typename Shape::sig>;
+    constexpr std::size_t depth = 4;
+    typename Shape::fn fn;
+    std::array<hop<view, typename Shape::arg_type>, depth> hops;
+    std::array<view, depth + 1> views;
+    views[0] = view(fn);
+    for(std::size_t i = 0; i < depth; ++i)
+    {
+        hops[i].m_next = &views[i];
+        views[i + 1] = view(hops[i]);
+    }
+    benchmark::DoNotOptimize(views.data());
+    run_invoke<Shape>(state, views[depth]);
+}
+
+BENCHMARK_TEMPLATE(forward_view, vv6::func_view, scalar);
+BENCHMARK_TEMPLATE(forward_view, ref_view, scalar);
+BENCHMARK_TEMPLATE(forward_view, vv6::func_view, string_view);
+BENCHMARK_TEMPLATE(forward_view, ref_view, string_view);
+BENCHMARK_TEMPLATE(forward_view, vv6::func_view, pair);
+BENCHMARK_TEMPLATE(forward_view, ref_view, pair);
+
+//captures for the construct/move/destroy cycle
+
+struct trivial_capture
+{
+    int k = 1;
+    int operator()(int x) const
+    {
+        return x + k;
+    }
+};
+
+struct inline_capture
+{
+    int k = 1;
+
+    inline_capture() = default;
+    inline_capture(const inline_capture& other) noexcept : k(other.k) {}
+    inline_capture(inline_capture&& other) noexcept : k(other.k) {}
+
+    ~inline_capture()
+    {
+        benchmark::DoNotOptimize(k);
+    }
+
+    int operator()(int x) const
+    {
+        return x + k;
+    }
+};
+
+struct heap_capture
+{
+    int k = 1;
+    char payload[4 * sizeof(std::max_align_t)] = {};
+
+    int operator()(int x) const
+    {
+        return x + k + payload[0];
+    }
+};
+
+//keeps the last freed block of each type, stands in for an arena
+template <typename T>
+struct recycling_allocator
+{
+    using value_type = T;
+
+    static inline T* s_free = nullptr;
+
+    recycling_allocator() = default;
+
+    template <typename U>
+    recycling_allocator(const recycling_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if(n == 1 && s_free)
+        {
+            return std::exchange(s_free, nullptr);
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        if(n == 1 && !s_free)
+        {
+            s_free = p;
+            return;
+        }
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const recycling_allocator<U>&) const noexcept
+    {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const recycling_allocator<U>&) const noexcept
+    {
+        return false;
+    }
+};
+
+template <typename Capture>
+void lifecycle_unique_func(benchmark::State& state)
+{
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        vv6::unique_func<int(int) const> f(Capture{});
+        vv6::unique_func<int(int) const> g(std::move(f));
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+template <typename Capture>
+void lifecycle_unique_func_allocator(benchmark::State& state)
+{
+    recycling_allocator<char> alloc;
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        vv6::unique_func<int(int) const> f(std::allocator_arg, alloc, Capture{});
+        vv6::unique_func<int(int) const> g(std::move(f));
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+template <typename Capture>
+void lifecycle_unique_func_pool(benchmark::State& state)
+{
+    using func = vv6::basic_unique_func<int(int) const, vv6::default_capacity, vv6::default_alignment,
+                                        vv6::pool_policy>;
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        func f(Capture{});
+        func g(std::move(f));
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+//a per request arena, every callable of the request goes there and it is released at the end
+template <typename Capture, typename Resource>
+void lifecycle_unique_func_arena(benchmark::State& state)
+{
+    constexpr int per_request = 64;
+    alignas(std::max_align_t) static char buffer[per_request * 2 * sizeof(Capture)];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer));
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        for(int i = 0; i < per_request; ++i)
+        {
+            vv6::unique_func<int(int) const> f(std::allocator_arg, Resource(&arena), Capture{});
+            vv6::unique_func<int(int) const> g(std::move(f));
+            benchmark::DoNotOptimize(g);
+        }
+        arena.release();
+    }
+    state.SetItemsProcessed(state.iterations() * per_request);
+}
+
+template <typename Capture>
+void lifecycle_std_function(benchmark::State& state)
+{
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        std::function<int(int)> f(Capture{});
+        std::function<int(int)> g(std::move(f));
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+template <typename Capture>
+void lifecycle_shared_func(benchmark::State& state)
+{
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        auto f = vv6::make_shared_func<int(int)>(Capture{});
+        auto g(std::move(f));
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+template <typename Capture>
+void lifecycle_shared_func_allocator(benchmark::State& state)
+{
+    recycling_allocator<char> alloc;
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        vv6::shared_func<int(int)> f(std::allocate_shared<Capture>(alloc));
+        auto g(std::move(f));
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+template <typename Capture>
+void lifecycle_intrusive_func(benchmark::State& state)
+{
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        auto f = vv6::make_intrusive_func<int(int)>(Capture{});
+        auto g(std::move(f));
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+#define VV6_BENCH_LIFECYCLE(capture) \
+    BENCHMARK_TEMPLATE(lifecycle_unique_func, capture); \
+    BENCHMARK_TEMPLATE(lifecycle_unique_func_allocator, capture); \
+    BENCHMARK_TEMPLATE(lifecycle_unique_func_pool, capture); \
+    BENCHMARK_TEMPLATE(lifecycle_std_function, capture); \
+    BENCHMARK_TEMPLATE(lifecycle_shared_func, capture); \
+    BENCHMARK_TEMPLATE(lifecycle_shared_func_allocator, capture); \
+    BENCHMARK_TEMPLATE(lifecycle_intrusive_func, capture)
+
+VV6_BENCH_LIFECYCLE(trivial_capture);
+VV6_BENCH_LIFECYCLE(inline_capture);
+VV6_BENCH_LIFECYCLE(heap_capture);
+BENCHMARK_TEMPLATE(lifecycle_unique_func_arena, heap_capture, std::pmr::polymorphic_allocator<char>);
+BENCHMARK_TEMPLATE(lifecycle_unique_func_arena, heap_capture, vv6::releasable_resource);
+
+template <typename Capture>
+void move_unique_func(benchmark::State& state)
+{
+    vv6::unique_func<int(int) const> f(Capture{}), g;
+    for(auto _ : state)
+    {
+        g = std::move(f);
+        benchmark::DoNotOptimize(g);
+        f = std::move(g);
+        benchmark::DoNotOptimize(f);
+    }
+}
+
+template <typename Capture>
+void move_std_function(benchmark::State& state)
+{
+    std::function<int(int)> f(Capture{}), g;
+    for(auto _ : state)
+    {
+        g = std::move(f);
+        benchmark::DoNotOptimize(g);
+        f = std::move(g);
+        benchmark::DoNotOptimize(f);
+    }
+}
+
+//owns a heap object, moved by its move constructor unless it is known to be relocatable
+struct owning_capture
+{
+    std::unique_ptr<int> k = std::make_unique<int>(1);
+
+    int operator()(int x) const
+    {
+        return x + *k;
+    }
+};
+
+struct relocatable_capture : owning_capture {};
+
+}
+
+template <>
+struct vv6::is_trivially_relocatable<relocatable_capture> : std::true_type {};
+
+namespace
+{
+
+//moves a full container into a new one, as a vector does when it grows
+template <typename Capture>
+void relocate_unique_func(benchmark::State& state)
+{
+    std::vector<vv6::unique_func<int(int) const>> v(state.range(0)), w;
+    for(auto& f : v)
+    {
+        f = Capture{};
+    }
+    for(auto _ : state)
+    {
+        w.clear();
+        w.reserve(v.size());
+        for(auto& f : v)
+        {
+            w.emplace_back(std::move(f));
+        }
+        std::swap(v, w);
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Capture>
+void copy_shared_func(benchmark::State& state)
+{
+    auto f = vv6::make_shared_func<int(int)>(Capture{});
+    for(auto _ : state)
+    {
+        auto g(f);
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+template <typename Count>
+void copy_intrusive_func(benchmark::State& state)
+{
+    auto f = vv6::make_intrusive_func<int(int), Count>(trivial_capture{});
+    for(auto _ : state)
+    {
+        auto g(f);
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+template <typename Capture>
+void copy_copy_func(benchmark::State& state)
+{
+    vv6::copy_func<int(int) const> f(Capture{});
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        auto g(f);
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+template <typename Capture>
+void copy_std_function(benchmark::State& state)
+{
+    std::function<int(int)> f(Capture{});
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        auto g(f);
+        benchmark::DoNotOptimize(g);
+    }
+}
+
+BENCHMARK_TEMPLATE(move_unique_func, trivial_capture);
+BENCHMARK_TEMPLATE(move_unique_func, inline_capture);
+BENCHMARK_TEMPLATE(move_unique_func, heap_capture);
+BENCHMARK_TEMPLATE(move_std_function, trivial_capture);
+BENCHMARK_TEMPLATE(move_std_function, inline_capture);
+BENCHMARK_TEMPLATE(move_std_function, heap_capture);
+BENCHMARK_TEMPLATE(relocate_unique_func, owning_capture)->Arg(1 << 10);
+BENCHMARK_TEMPLATE(relocate_unique_func, relocatable_capture)->Arg(1 << 10);
+BENCHMARK_TEMPLATE(relocate_unique_func, heap_capture)->Arg(1 << 10);
+BENCHMARK_TEMPLATE(copy_copy_func, trivial_capture);
+BENCHMARK_TEMPLATE(copy_copy_func, inline_capture);
+BENCHMARK_TEMPLATE(copy_copy_func, heap_capture);
+BENCHMARK_TEMPLATE(copy_std_function, trivial_capture);
+BENCHMARK_TEMPLATE(copy_std_function, inline_capture);
+BENCHMARK_TEMPLATE(copy_std_function, heap_capture);
+BENCHMARK_TEMPLATE(copy_shared_func, trivial_capture);
+BENCHMARK_TEMPLATE(copy_intrusive_func, vv6::atomic_count);
+BENCHMARK_TEMPLATE(copy_intrusive_func, vv6::local_count);
+
+//a dispatch loop where most callables are of a few known types
+
+template <int N>
+struct step
+{
+    int operator()(int x) const
+    {
+        return x * N + 1;
+    }
+};
+
+std::vector<vv6::unique_func<int(int) const>> make_steps(std::size_t n)
+{
+    std::vector<vv6::unique_func<int(int) const>> funcs;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        switch(i % 8)
+        {
+        case 0: case 1: case 2: case 3:
+            funcs.emplace_back(step<3>{});
+            break;
+        case 4: case 5: case 6:
+            funcs.emplace_back(step<5>{});
+            break;
+        default:
+            funcs.emplace_back([k = int(i)](int x) { return x ^ k; });
+        }
+    }
+    return funcs;
+}
+
+void dispatch_unique_func(benchmark::State& state)
+{
+    auto funcs = make_steps(1024);
+    for(auto _ : state)
+    {
+        int x = 0;
+        for(auto& f : funcs)
+        {
+            x = f(int(x));
+        }
+        benchmark::DoNotOptimize(x);
+    }
+    state.SetItemsProcessed(state.iterations() * funcs.size());
+}
+
+void dispatch_unique_func_visit(benchmark::State& state)
+{
+    auto funcs = make_steps(1024);
+    for(auto _ : state)
+    {
+        int x = 0;
+        for(auto& f : funcs)
+        {
+            x = vv6::visit<step<3>, step<5>>(f, int(x));
+        }
+        benchmark::DoNotOptimize(x);
+    }
+    state.SetItemsProcessed(state.iterations() * funcs.size());
+}
+
+BENCHMARK(dispatch_unique_func);
+BENCHMARK(dispatch_unique_func_visit);
+
+}
@@ -0,0 +1,93 @@
+#include <vector>
+
+#include <vv6/unique_func.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+//56 bytes of storage: 72 byte objects with the inline invoker, a cache line with the vtable
+template <typename Policy>
+using func = vv6::basic_unique_func<long(long), 56, alignof(void*), Policy>;
+
+template <int N>
+struct add
+{
+    long m_value[N];
+
+    long operator()(long x)
+    {
+        return x + m_value[0];
+    }
+};
+
+template <typename Policy>
+std::vector<func<Policy>> make_funcs(std::size_t n)
+{
+    std::vector<func<Policy>> v;
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        switch(i % 4)
+        {
+        case 0: v.emplace_back(add<1>{{long(i)}}); break;
+        case 1: v.emplace_back(add<2>{{long(i)}}); break;
+        case 2: v.emplace_back(add<4>{{long(i)}}); break;
+        default: v.emplace_back(add<7>{{long(i)}}); break;
+        }
+    }
+    return v;
+}
+
+//walks a container too large for the caches, the footprint matters more than the indirection
+template <typename Policy>
+void layout_invoke_all(benchmark::State& state)
+{
+    auto v = make_funcs<Policy>(state.range(0));
+    long sum = 0;
+    for(auto _ : state)
+    {
+        for(auto& f : v)
+        {
+            sum = f(long(sum));
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes"] = sizeof(func<Policy>);
+}
+
+//the same callable over and over, the indirection is all there is
+template <typename Policy>
+void layout_invoke_one(benchmark::State& state)
+{
+    func<Policy> f(add<1>{{1}});
+    long sum = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(f);
+        sum = f(long(sum));
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+//growing without reserve, every reallocation moves the whole container
+template <typename Policy>
+void layout_grow(benchmark::State& state)
+{
+    for(auto _ : state)
+    {
+        auto v = make_funcs<Policy>(state.range(0));
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK_TEMPLATE(layout_invoke_one, vv6::default_policy);
+BENCHMARK_TEMPLATE(layout_invoke_one, vv6::vtable_policy);
+BENCHMARK_TEMPLATE(layout_invoke_all, vv6::default_policy)->Arg(1 << 10)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_invoke_all, vv6::vtable_policy)->Arg(1 << 10)->Arg(1 << 18);
+BENCHMARK_TEMPLATE(layout_grow, vv6::default_policy)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(layout_grow, vv6::vtable_policy)->Arg(1 << 10)->Arg(1 << 16);
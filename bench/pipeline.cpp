@@ -0,0 +1,78 @@
+#include <utility>
+
+#include <vv6/pipeline.hpp>
+#include <vv6/unique_func.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include "allocation.hpp"
+
+namespace
+{
+
+using func = vv6::unique_func<long(long)>;
+
+struct add
+{
+    long m_value;
+
+    long operator()(long x) const
+    {
+        return x + m_value;
+    }
+};
+
+struct twice
+{
+    long operator()(long x) const
+    {
+        return 2 * x;
+    }
+};
+
+//what is written without compose: every step wraps two wrappers into a third one
+func then(func a, func b)
+{
+    return func([a = std::move(a), b = std::move(b)](long x) mutable { return b(a(long(x))); });
+}
+
+func make_nested(long i)
+{
+    return then(then(func(add{i}), func(twice{})), func(add{1}));
+}
+
+func make_composed(long i)
+{
+    return func(vv6::compose(add{i}, twice{}, add{1}));
+}
+
+template <func (*Make)(long)>
+void build_pipeline(benchmark::State& state)
+{
+    long i = 0;
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        auto f = Make(++i);
+        benchmark::DoNotOptimize(f);
+    }
+}
+
+template <func (*Make)(long)>
+void call_pipeline(benchmark::State& state)
+{
+    auto f = Make(1);
+    long sum = 0;
+    for(auto _ : state)
+    {
+        sum = f(long(sum)) & 0xffff;
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+}
+
+BENCHMARK_TEMPLATE(build_pipeline, make_nested);
+BENCHMARK_TEMPLATE(build_pipeline, make_composed);
+BENCHMARK_TEMPLATE(call_pipeline, make_nested);
+BENCHMARK_TEMPLATE(call_pipeline, make_composed);
@@ -0,0 +1,113 @@
+#include <deque>
+#include <mutex>
+
+#include <vv6/func_queue.hpp>
+#include <vv6/unique_func.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+constexpr std::size_t batch = 64;
+
+//what a queue of wrappers does: the wrapper is built, moved in and moved out again
+class locked_queue
+{
+    std::mutex m_mutex;
+    std::deque<vv6::unique_func<void()>> m_queue;
+public:
+    void push(vv6::unique_func<void()> f)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(f));
+    }
+
+    bool pop(vv6::unique_func<void()>& f)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_queue.empty())
+        {
+            return false;
+        }
+        f = std::move(m_queue.front());
+        m_queue.pop_front();
+        return true;
+    }
+};
+
+struct task
+{
+    long* m_sum;
+    long m_value[4];
+
+    void operator()()
+    {
+        *m_sum += m_value[0];
+    }
+};
+
+void queue_func_queue(benchmark::State& state)
+{
+    vv6::func_queue<void()> q(batch);
+    long sum = 0;
+    for(auto _ : state)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            q.try_push(task{&sum, {long(i)}});
+        }
+        while(q.try_invoke())
+        {
+
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+void queue_func_queue_pop(benchmark::State& state)
+{
+    vv6::func_queue<void()> q(batch);
+    vv6::unique_func<void()> f;
+    long sum = 0;
+    for(auto _ : state)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            q.try_push(vv6::unique_func<void()>(task{&sum, {long(i)}}));
+        }
+        while(q.try_pop(f))
+        {
+            f();
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+void queue_locked(benchmark::State& state)
+{
+    locked_queue q;
+    vv6::unique_func<void()> f;
+    long sum = 0;
+    for(auto _ : state)
+    {
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            q.push(task{&sum, {long(i)}});
+        }
+        while(q.pop(f))
+        {
+            f();
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+}
+
+BENCHMARK(queue_func_queue);
+BENCHMARK(queue_func_queue_pop);
+BENCHMARK(queue_locked);
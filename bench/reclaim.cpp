@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <vv6/func_reclaimer.hpp>
+#include <vv6/unique_func.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+//a handler which owns a large buffer, as one of a connection would
+struct heavy
+{
+    std::unique_ptr<long[]> m_buffer = std::make_unique<long[]>(1 << 14);
+
+    long operator()(long x) const
+    {
+        return x + m_buffer[0];
+    }
+};
+
+//only the destruction of the handlers is timed, that is what the critical thread pays.
+//worst is the slowest batch in microseconds
+template <typename Policy>
+void destroy_handlers(benchmark::State& state)
+{
+    using func = vv6::basic_unique_func<long(long) const, vv6::default_capacity, vv6::default_alignment, Policy>;
+    std::vector<func> v;
+    double worst = 0;
+    for(auto _ : state)
+    {
+        for(long i = 0; i < state.range(0); ++i)
+        {
+            v.emplace_back(heavy());
+        }
+        auto start = std::chrono::steady_clock::now();
+        v.clear();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        state.SetIterationTime(elapsed.count());
+        worst = std::max(worst, elapsed.count() * 1e6);
+        if constexpr(!std::is_same_v<Policy, vv6::default_policy>)
+        {
+            vv6::func_reclaimer::drain();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["worst"] = worst;
+}
+
+}
+
+BENCHMARK_TEMPLATE(destroy_handlers, vv6::default_policy)->Arg(64)->UseManualTime();
+BENCHMARK_TEMPLATE(destroy_handlers, vv6::deferred_policy)->Arg(64)->UseManualTime();
@@ -0,0 +1,123 @@
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <vv6/signal.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+//what every team writes by hand
+class locked_signal
+{
+    mutable std::mutex m_mutex;
+    std::vector<std::function<void(int)>> m_slots;
+public:
+    template <typename T>
+    void connect(T&& t)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots.emplace_back(std::forward<T>(t));
+    }
+
+    void emit(int x) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto& s : m_slots)
+        {
+            s(x);
+        }
+    }
+};
+
+struct slot
+{
+    long* m_sum;
+
+    void operator()(int x) const
+    {
+        *m_sum += x;
+    }
+};
+
+//one sink per thread, so that the slots themselves do not contend
+template <typename Signal>
+struct fixture
+{
+    static std::unique_ptr<Signal> s_signal;
+    static std::vector<long> s_sums;
+
+    static void setup(const benchmark::State& state)
+    {
+        if(state.thread_index() == 0)
+        {
+            s_signal = std::make_unique<Signal>();
+            s_sums.assign(64, 0);
+            for(long i = 0; i < state.range(0); ++i)
+            {
+                s_signal->connect(slot{&s_sums[0]});
+            }
+        }
+    }
+
+    static void teardown(const benchmark::State& state)
+    {
+        if(state.thread_index() == 0)
+        {
+            s_signal.reset();
+        }
+    }
+};
+
+template <typename Signal>
+std::unique_ptr<Signal> fixture<Signal>::s_signal;
+
+template <typename Signal>
+std::vector<long> fixture<Signal>::s_sums;
+
+template <typename Signal>
+void emit(benchmark::State& state)
+{
+    using f = fixture<Signal>;
+    f::setup(state);
+    for(auto _ : state)
+    {
+        f::s_signal->emit(1);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    f::teardown(state);
+}
+
+void emit_locked_signal(benchmark::State& state)
+{
+    emit<locked_signal>(state);
+}
+
+void emit_signal(benchmark::State& state)
+{
+    emit<vv6::signal<void(int)>>(state);
+}
+
+//connect and disconnect, the cost moved off the emitting side
+void subscribe_signal(benchmark::State& state)
+{
+    vv6::signal<void(int)> sig;
+    long sum = 0;
+    for(long i = 0; i < state.range(0); ++i)
+    {
+        sig.connect(slot{&sum});
+    }
+    for(auto _ : state)
+    {
+        sig.connect(slot{&sum}).disconnect();
+    }
+}
+
+}
+
+BENCHMARK(emit_locked_signal)->RangeMultiplier(8)->Range(1, 512)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(emit_signal)->RangeMultiplier(8)->Range(1, 512)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(subscribe_signal)->RangeMultiplier(8)->Range(1, 512);
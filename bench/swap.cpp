@@ -0,0 +1,113 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <vv6/atomic_shared_func.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using handler_type = vv6::shared_func<long(long)>;
+
+struct handler
+{
+    long m_value;
+
+    long operator()(long x) const
+    {
+        return x + m_value;
+    }
+};
+
+//what every team writes by hand, the copy keeps the lock out of the call
+class locked_slot
+{
+    mutable std::mutex m_mutex;
+    handler_type m_f;
+public:
+    void store(handler_type f)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_f = std::move(f);
+    }
+
+    long operator()(long x) const
+    {
+        handler_type f;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            f = m_f;
+        }
+        return f(long(x));
+    }
+};
+
+//the C++11 free functions on a shared_ptr, libstdc++ guards them with a pool of mutexes
+class shared_ptr_slot
+{
+    std::shared_ptr<const handler_type> m_f;
+public:
+    void store(handler_type f)
+    {
+        std::atomic_store(&m_f, std::make_shared<const handler_type>(std::move(f)));
+    }
+
+    long operator()(long x) const
+    {
+        return (*std::atomic_load(&m_f))(long(x));
+    }
+};
+
+class atomic_slot
+{
+    vv6::atomic_shared_func<long(long)> m_f;
+public:
+    void store(handler_type f)
+    {
+        m_f.store(std::move(f));
+    }
+
+    long operator()(long x) const
+    {
+        return m_f(long(x));
+    }
+};
+
+template <typename Slot>
+std::unique_ptr<Slot> s_slot;
+
+//every thread calls, the first one also swaps the handler every range(0) calls
+template <typename Slot>
+void swap_readers(benchmark::State& state)
+{
+    if(state.thread_index() == 0)
+    {
+        s_slot<Slot> = std::make_unique<Slot>();
+        s_slot<Slot>->store(vv6::make_shared_func<long(long)>(handler{1}));
+    }
+    long sum = 0;
+    long n = 0;
+    for(auto _ : state)
+    {
+        sum = (*s_slot<Slot>)(long(sum));
+        if(state.thread_index() == 0 && ++n == state.range(0))
+        {
+            s_slot<Slot>->store(vv6::make_shared_func<long(long)>(handler{sum & 1}));
+            n = 0;
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+    if(state.thread_index() == 0)
+    {
+        s_slot<Slot>.reset();
+    }
+}
+
+}
+
+BENCHMARK_TEMPLATE(swap_readers, locked_slot)->Arg(1 << 10)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(swap_readers, shared_ptr_slot)->Arg(1 << 10)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(swap_readers, atomic_slot)->Arg(1 << 10)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,174 @@
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <vv6/thread_pool.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+//the usual pool, one queue of std::function behind a mutex and a condition variable
+class locked_pool
+{
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_queue;
+    bool m_stop = false;
+    std::vector<std::thread> m_threads;
+
+    void run()
+    {
+        for(;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [&] { return m_stop || !m_queue.empty(); });
+                if(m_queue.empty())
+                {
+                    return;
+                }
+                task = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            task();
+        }
+    }
+
+public:
+    explicit locked_pool(std::size_t threads)
+    {
+        for(std::size_t i = 0; i < threads; ++i)
+        {
+            m_threads.emplace_back([this] { run(); });
+        }
+    }
+
+    ~locked_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for(auto& t : m_threads)
+        {
+            t.join();
+        }
+    }
+
+    template <typename T>
+    void post(T&& t)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.emplace_back(std::forward<T>(t));
+        }
+        m_cv.notify_one();
+    }
+};
+
+class latch
+{
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<long> m_count{0};
+public:
+    void reset(long count)
+    {
+        m_count.store(count);
+    }
+
+    void count_down()
+    {
+        if(m_count.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cv.notify_all();
+        }
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_count.load() == 0; });
+    }
+};
+
+constexpr int depth = 14;
+
+//a binary tree of tasks, every task spawns two more until the leaves count down the latch
+template <typename Pool>
+struct spawn
+{
+    Pool* m_pool;
+    latch* m_done;
+    int m_depth;
+
+    void operator()() const
+    {
+        if(m_depth == 0)
+        {
+            m_done->count_down();
+            return;
+        }
+        m_pool->post(spawn{m_pool, m_done, m_depth - 1});
+        m_pool->post(spawn{m_pool, m_done, m_depth - 1});
+    }
+};
+
+template <typename Pool>
+void pool_spawn(benchmark::State& state)
+{
+    Pool pool(state.range(0));
+    latch done;
+    for(auto _ : state)
+    {
+        done.reset(1 << depth);
+        pool.post(spawn<Pool>{&pool, &done, depth});
+        done.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * ((2 << depth) - 1));
+}
+
+//many independent tasks posted from outside the pool
+template <typename Pool>
+void pool_post(benchmark::State& state)
+{
+    constexpr long tasks = 1 << 14;
+    Pool pool(state.range(0));
+    latch done;
+    for(auto _ : state)
+    {
+        done.reset(tasks);
+        for(long i = 0; i < tasks; ++i)
+        {
+            pool.post([&done] { done.count_down(); });
+        }
+        done.wait();
+    }
+    state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+void thread_counts(benchmark::internal::Benchmark* b)
+{
+    long n = std::max(1u, std::thread::hardware_concurrency());
+    for(long i = 1; i < n; i *= 2)
+    {
+        b->Arg(i);
+    }
+    b->Arg(n);
+    b->UseRealTime();
+}
+
+}
+
+BENCHMARK_TEMPLATE(pool_spawn, vv6::thread_pool)->Apply(thread_counts);
+BENCHMARK_TEMPLATE(pool_spawn, locked_pool)->Apply(thread_counts);
+BENCHMARK_TEMPLATE(pool_post, vv6::thread_pool)->Apply(thread_counts);
+BENCHMARK_TEMPLATE(pool_post, locked_pool)->Apply(thread_counts);
@@ -0,0 +1,137 @@
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include <vv6/timer_wheel.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+//timeouts of requests: most are cancelled when the reply comes, a quarter fires
+constexpr std::size_t in_flight = 1024;
+constexpr std::size_t per_tick = 64;
+
+std::uint64_t delay_of(std::size_t i) noexcept
+{
+    return 1 + (i * 2654435761u) % 4096;
+}
+
+//what is usually written: a heap of std::function, cancelled entries are marked and skipped when they come up
+class heap_timers
+{
+    struct entry
+    {
+        std::uint64_t m_deadline;
+        std::size_t m_id;
+        std::function<void()> m_func;
+
+        bool operator<(const entry& other) const noexcept
+        {
+            return m_deadline > other.m_deadline;
+        }
+    };
+
+    std::priority_queue<entry> m_heap;
+    std::vector<bool> m_cancelled;
+    std::uint64_t m_now = 0;
+public:
+    using handle = std::size_t;
+
+    template <typename F>
+    handle schedule(std::uint64_t delay, F&& f)
+    {
+        auto id = m_cancelled.size();
+        m_cancelled.push_back(false);
+        m_heap.push(entry{m_now + delay, id, std::forward<F>(f)});
+        return id;
+    }
+
+    void cancel(handle h)
+    {
+        m_cancelled[h] = true;
+    }
+
+    void advance(std::uint64_t ticks)
+    {
+        m_now += ticks;
+        while(!m_heap.empty() && m_heap.top().m_deadline <= m_now)
+        {
+            if(!m_cancelled[m_heap.top().m_id])
+            {
+                m_heap.top().m_func();
+            }
+            m_heap.pop();
+        }
+    }
+
+    bool empty() const noexcept
+    {
+        return m_heap.empty();
+    }
+};
+
+class wheel_timers
+{
+    vv6::timer_wheel<> m_wheel;
+public:
+    using handle = vv6::timer_wheel<>::handle;
+
+    template <typename F>
+    handle schedule(std::uint64_t delay, F&& f)
+    {
+        return m_wheel.schedule(delay, std::forward<F>(f));
+    }
+
+    void cancel(handle h)
+    {
+        m_wheel.cancel(h);
+    }
+
+    void advance(std::uint64_t ticks)
+    {
+        m_wheel.advance(ticks);
+    }
+
+    bool empty() const noexcept
+    {
+        return m_wheel.empty();
+    }
+};
+
+template <typename Timers>
+void schedule_cancel(benchmark::State& state)
+{
+    long sum = 0;
+    for(auto _ : state)
+    {
+        Timers timers;
+        std::vector<typename Timers::handle> handles(in_flight);
+        for(std::size_t i = 0; i < std::size_t(state.range(0)); ++i)
+        {
+            auto& h = handles[i % in_flight];
+            if(i >= in_flight && i % 4)
+            {
+                timers.cancel(h);
+            }
+            h = timers.schedule(delay_of(i), [&sum, i]() { sum += long(i); });
+            if(i % per_tick == per_tick - 1)
+            {
+                timers.advance(1);
+            }
+        }
+        while(!timers.empty())
+        {
+            timers.advance(per_tick);
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK_TEMPLATE(schedule_cancel, heap_timers)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(schedule_cancel, wheel_timers)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
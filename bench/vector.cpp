@@ -0,0 +1,101 @@
+#include <array>
+#include <vector>
+
+#include <vv6/func_vector.hpp>
+#include <vv6/unique_func.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include "allocation.hpp"
+
+namespace
+{
+
+//deferred work of one frame, mostly a pointer or two, every eighth carries a larger payload
+template <typename Push>
+void fill_frame(long& sum, std::size_t n, Push push)
+{
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        if(i % 8 == 7)
+        {
+            push([&sum, payload = std::array<long, 12>{long(i)}]() { sum += payload[0]; });
+        }
+        else if(i % 2)
+        {
+            push([&sum, i]() { sum += long(i); });
+        }
+        else
+        {
+            push([&sum]() { ++sum; });
+        }
+    }
+}
+
+//the containers are reused from frame to frame, as a game loop would
+void frame_vector_unique_func(benchmark::State& state)
+{
+    std::vector<vv6::unique_func<void()>> v;
+    long sum = 0;
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        fill_frame(sum, state.range(0), [&](auto&& f) { v.emplace_back(std::move(f)); });
+        for(auto& f : v)
+        {
+            f();
+        }
+        v.clear();
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes"] = static_cast<double>(sizeof(vv6::unique_func<void()>));
+}
+
+void frame_func_vector(benchmark::State& state)
+{
+    vv6::func_vector<void()> v;
+    long sum = 0;
+    bench::allocation_counter counter(state);
+    for(auto _ : state)
+    {
+        fill_frame(sum, state.range(0), [&](auto&& f) { v.push_back(std::move(f)); });
+        v.invoke_all();
+        state.counters["bytes"] = static_cast<double>(v.bytes()) / state.range(0);
+        v.clear();
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+//growing from empty every time, the whole buffer is relocated with memcpy
+void grow_func_vector(benchmark::State& state)
+{
+    long sum = 0;
+    for(auto _ : state)
+    {
+        vv6::func_vector<void()> v;
+        fill_frame(sum, state.range(0), [&](auto&& f) { v.push_back(std::move(f)); });
+        benchmark::DoNotOptimize(v.bytes());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void grow_vector_unique_func(benchmark::State& state)
+{
+    long sum = 0;
+    for(auto _ : state)
+    {
+        std::vector<vv6::unique_func<void()>> v;
+        fill_frame(sum, state.range(0), [&](auto&& f) { v.emplace_back(std::move(f)); });
+        benchmark::DoNotOptimize(v.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}
+
+BENCHMARK(frame_vector_unique_func)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(frame_func_vector)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(grow_vector_unique_func)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(grow_func_vector)->Arg(1 << 10)->Arg(1 << 16);
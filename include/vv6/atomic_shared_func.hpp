@@ -0,0 +1,141 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "rcu_readers.hpp"
+#include "shared_func.hpp"
+
+namespace vv6
+{
+
+template <typename Sig>
+class atomic_shared_func;
+
+//a shared_func which may be replaced while other threads call it.
+//callers take no lock, they note the global epoch in a record of their own thread and find the current one
+//behind an atomic pointer. load does the same and copies it, which increments its reference count.
+//store and exchange publish a new one under a mutex and free what was replaced before, once no reader
+//can see it anymore. readers never free anything, the last ones replaced live until the next store or
+//the destruction. a call still running on the old one completes on it
+template <typename Ret, typename... Args>
+class atomic_shared_func<Ret(Args...)>
+{
+public:
+    using value_type = shared_func<Ret(Args...)>;
+
+private:
+    std::atomic<const value_type*> m_current;
+    std::mutex m_mutex;
+    details::rcu_retired<const value_type> m_retired;
+
+    //keeps the current one alive while it is used
+    class read_guard
+    {
+        const atomic_shared_func& m_self;
+        details::rcu_readers::record& m_record;
+    public:
+        explicit read_guard(const atomic_shared_func& self) :
+            m_self(self), m_record(details::rcu_readers::s_enter())
+        {
+
+        }
+
+        read_guard(const read_guard&) = delete;
+        read_guard& operator=(const read_guard&) = delete;
+
+        ~read_guard()
+        {
+            details::rcu_readers::s_leave(m_record);
+        }
+
+        const value_type* get() const noexcept
+        {
+            return m_self.m_current.load(std::memory_order_seq_cst);
+        }
+    };
+
+    //under the mutex, the retired list must have room for one more
+    void publish(std::unique_ptr<const value_type> next) noexcept
+    {
+        std::unique_ptr<const value_type> prev(m_current.exchange(next.release(), std::memory_order_seq_cst));
+        auto tag = details::rcu_readers::s_retire();
+        if(prev)
+        {
+            m_retired.retire(tag, std::move(prev));
+        }
+        m_retired.reclaim(details::rcu_readers::s_oldest());
+    }
+
+    static std::unique_ptr<const value_type> s_make(value_type f)
+    {
+        if(!f)
+        {
+            return nullptr;
+        }
+        return std::make_unique<const value_type>(std::move(f));
+    }
+
+public:
+    atomic_shared_func() noexcept :
+        m_current(nullptr)
+    {
+
+    }
+
+    explicit atomic_shared_func(value_type f) :
+        m_current(s_make(std::move(f)).release())
+    {
+
+    }
+
+    atomic_shared_func(const atomic_shared_func&) = delete;
+    atomic_shared_func& operator=(const atomic_shared_func&) = delete;
+
+    //nobody may use it any longer
+    ~atomic_shared_func()
+    {
+        delete m_current.load(std::memory_order_relaxed);
+    }
+
+    //the current one, it stays alive as long as the copy does
+    value_type load() const
+    {
+        read_guard guard(*this);
+        auto cur = guard.get();
+        return cur ? *cur : value_type();
+    }
+
+    void store(value_type f)
+    {
+        auto next = s_make(std::move(f));
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_retired.reserve(1);
+        publish(std::move(next));
+    }
+
+    value_type exchange(value_type f)
+    {
+        auto next = s_make(std::move(f));
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_retired.reserve(1);
+        auto prev = m_current.load(std::memory_order_relaxed);
+        value_type r = prev ? *prev : value_type();
+        publish(std::move(next));
+        return r;
+    }
+
+    //calls the current one, it must not be empty
+    Ret operator()(Args&&... args) const
+    {
+        read_guard guard(*this);
+        return (*guard.get())(std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_current.load(std::memory_order_acquire) != nullptr;
+    }
+};
+
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+template <typename Sig, std::size_t Size = default_capacity, std::size_t Align = default_alignment,
+          typename Policy = default_policy>
+class basic_copy_func;
+
+template <typename Sig>
+using copy_func = basic_copy_func<Sig>;
+
+template <typename Ret, typename... Args, std::size_t Size, std::size_t Align, typename Policy>
+class basic_copy_func<Ret(Args...), Size, Align, Policy> : public uf_details::unique_func_base<Ret(Args...), Size, Align, Policy>
+{
+    using signature_type = Ret(Args ...);
+    using base_type = uf_details::unique_func_base<Ret(Args...), Size, Align, Policy>;
+
+    template <std::size_t OSize, std::size_t OAlign>
+    static std::bool_constant<base_type::template can_adopt<OSize, OAlign>>
+    s_adoptable(const basic_copy_func<Ret(Args...), OSize, OAlign, Policy>*);
+    template <std::size_t OSize, std::size_t OAlign>
+    static std::bool_constant<base_type::template can_adopt<OSize, OAlign>>
+    s_adoptable(const basic_copy_func<Ret(Args...) const, OSize, OAlign, Policy>*);
+    static std::false_type s_adoptable(...);
+
+    template <typename T>
+    static constexpr bool proper = !std::is_convertible_v<T*, basic_copy_func*> &&
+            !decltype(s_adoptable(std::declval<T*>()))::value &&
+            std::is_copy_constructible_v<T> &&
+            std::is_invocable_r_v<Ret, T&, Args&&...>;
+public:
+    using base_type::base_type;
+
+    template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_copy_func(T&& t)
+    {
+        base_type::template construct<signature_type, std::decay_t<T>>(this, std::forward<T>(t));
+    }
+
+    template <typename Allocator, typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_copy_func(std::allocator_arg_t, const Allocator& a, T&& t)
+    {
+        base_type::template construct<signature_type, std::decay_t<T>>(this, std::allocator_arg, a, std::forward<T>(t));
+    }
+
+    template <typename T, typename... DTArgs, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_copy_func(std::in_place_type_t<T>, DTArgs&&... args)
+    {
+        base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
+    }
+
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign>, int> = 0>
+    basic_copy_func(basic_copy_func<Ret(Args...), OSize, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign>, int> = 0>
+    basic_copy_func(basic_copy_func<Ret(Args...) const, OSize, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign>, int> = 0>
+    basic_copy_func(const basic_copy_func<Ret(Args...), OSize, OAlign, Policy>& other) : base_type()
+    {
+        base_type::copy_from(other);
+    }
+
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign>, int> = 0>
+    basic_copy_func(const basic_copy_func<Ret(Args...) const, OSize, OAlign, Policy>& other) : base_type()
+    {
+        base_type::copy_from(other);
+    }
+
+    basic_copy_func(const basic_copy_func& other) : base_type()
+    {
+        base_type::copy_from(other);
+    }
+
+    basic_copy_func(basic_copy_func&&) noexcept = default;
+
+    basic_copy_func& operator=(const basic_copy_func& other)
+    {
+        if(this != &other)
+        {
+            *this = basic_copy_func(other);
+        }
+        return *this;
+    }
+
+    basic_copy_func& operator=(basic_copy_func&&) noexcept = default;
+
+    Ret operator()(Args&& ...args)
+    {
+        return base_type::call(std::forward<Args>(args)...);
+    }
+};
+
+template <typename Ret, typename... Args, std::size_t Size, std::size_t Align, typename Policy>
+class basic_copy_func<Ret(Args...) const, Size, Align, Policy> : public uf_details::unique_func_base<Ret(Args...), Size, Align, Policy>
+{
+    using signature_type = Ret(Args ...) const;
+    using base_type = uf_details::unique_func_base<Ret(Args...), Size, Align, Policy>;
+
+    template <std::size_t OSize, std::size_t OAlign>
+    static std::bool_constant<base_type::template can_adopt<OSize, OAlign>>
+    s_adoptable(const basic_copy_func<Ret(Args...) const, OSize, OAlign, Policy>*);
+    static std::false_type s_adoptable(...);
+
+    template <typename T>
+    static constexpr bool proper = !std::is_convertible_v<T*, basic_copy_func*> &&
+            !decltype(s_adoptable(std::declval<T*>()))::value &&
+            std::is_copy_constructible_v<T> &&
+            std::is_invocable_r_v<Ret, const T&, Args&&...>;
+public:
+    using base_type::base_type;
+
+    template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_copy_func(T&& t)
+    {
+        base_type::template construct<signature_type, std::decay_t<T>>(this, std::forward<T>(t));
+    }
+
+    template <typename Allocator, typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_copy_func(std::allocator_arg_t, const Allocator& a, T&& t)
+    {
+        base_type::template construct<signature_type, std::decay_t<T>>(this, std::allocator_arg, a, std::forward<T>(t));
+    }
+
+    template <typename T, typename... DTArgs, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_copy_func(std::in_place_type_t<T>, DTArgs&&... args)
+    {
+        base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
+    }
+
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign>, int> = 0>
+    basic_copy_func(basic_copy_func<Ret(Args...) const, OSize, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign>, int> = 0>
+    basic_copy_func(const basic_copy_func<Ret(Args...) const, OSize, OAlign, Policy>& other) : base_type()
+    {
+        base_type::copy_from(other);
+    }
+
+    basic_copy_func(const basic_copy_func& other) : base_type()
+    {
+        base_type::copy_from(other);
+    }
+
+    basic_copy_func(basic_copy_func&&) noexcept = default;
+
+    basic_copy_func& operator=(const basic_copy_func& other)
+    {
+        if(this != &other)
+        {
+            *this = basic_copy_func(other);
+        }
+        return *this;
+    }
+
+    basic_copy_func& operator=(basic_copy_func&&) noexcept = default;
+
+    Ret operator()(Args&& ...args) const
+    {
+        return base_type::call(std::forward<Args>(args)...);
+    }
+};
+
+}
@@ -0,0 +1,207 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "func_view.hpp"
+
+namespace vv6
+{
+
+template <typename Sig>
+class func_batch;
+
+namespace details
+{
+
+//calls all objects of one type, the call target is known inside the loop
+template <typename Sig, typename T, bool Const>
+struct batch_invoker;
+
+template <typename Ret, typename... Args, typename T, bool Const>
+struct batch_invoker<Ret(Args...), T, Const>
+{
+    static void s_invoke(const functor* objs, std::size_t n, std::remove_reference_t<Args>&... args)
+    {
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            functor_cast<T, Const>(objs[i])(static_cast<Args>(args)...);
+        }
+    }
+};
+
+}
+
+//non-owning collection of callables, grouped by their invoker.
+//invoke_all walks the groups, so the order of the calls is by group and not by insertion
+template <typename Ret, typename... Args>
+class func_batch<Ret(Args...)>
+{
+    static_assert((!std::is_rvalue_reference_v<Args> && ...),
+                  "func_batch cannot hand the same rvalue to several callables");
+
+    using view_type = func_view<Ret(Args...)>;
+    using invoker_type = Ret(*)(details::functor, details::argument_t<Args>...);
+    using batch_type = void(*)(const details::functor*, std::size_t, std::remove_reference_t<Args>&...);
+
+    //structure of arrays, one entry per group, there are usually only a few
+    std::vector<invoker_type> m_invokers;
+    std::vector<batch_type> m_batches;
+    std::vector<std::vector<details::functor>> m_objects;
+    std::size_t m_size = 0;
+
+    template <typename T>
+    static constexpr bool proper_class = std::is_class_v<T> &&
+            !std::is_same_v<T, view_type> &&
+            std::is_invocable_r_v<Ret, const T&, Args&&...>;
+
+    std::size_t group(invoker_type inv, batch_type batch)
+    {
+        std::size_t i = 0;
+        for(; i < m_invokers.size(); ++i)
+        {
+            if(m_invokers[i] == inv)
+            {
+                if(!m_batches[i])
+                {
+                    m_batches[i] = batch;
+                }
+                return i;
+            }
+        }
+        m_invokers.push_back(inv);
+        m_batches.push_back(batch);
+        m_objects.emplace_back();
+        return i;
+    }
+
+    void insert(details::functor fun, invoker_type inv, batch_type batch)
+    {
+        m_objects[group(inv, batch)].push_back(fun);
+        ++m_size;
+    }
+
+    template <typename T, bool Const>
+    void insert(const T& obj)
+    {
+        details::functor fun;
+        fun.obj = &obj;
+        insert(fun, &details::invoker<Ret(Args...), T, Const>::s_invoke,
+               &details::batch_invoker<Ret(Args...), T, Const>::s_invoke);
+    }
+
+public:
+    //the type behind a view is unknown, its group gets a batched trampoline
+    //only once an object of that type is added directly
+    void add(view_type f)
+    {
+        insert(details::func_view_access::get_functor(f), details::func_view_access::get_invoker(f), nullptr);
+    }
+
+    template <typename T, std::enable_if_t<proper_class<T>, int> = 0>
+    void add(const T& obj)
+    {
+        insert<T, true>(obj);
+    }
+
+    template <typename T, std::enable_if_t<proper_class<T>, int> = 0>
+    void add(const T&& obj) = delete;
+
+    template <typename T, std::enable_if_t<std::is_class_v<T> && std::is_invocable_r_v<Ret, T&, Args&&...>, int> = 0>
+    void add(use_non_const_type, T& obj)
+    {
+        insert<T, false>(obj);
+    }
+
+    //removes one callable which refers to the same target, the order within its group changes.
+    //a group is dropped with its last callable
+    bool remove(view_type f)
+    {
+        auto fun = details::func_view_access::get_functor(f);
+        auto inv = details::func_view_access::get_invoker(f);
+        for(std::size_t i = 0; i < m_invokers.size(); ++i)
+        {
+            if(m_invokers[i] != inv)
+            {
+                continue;
+            }
+            auto& objs = m_objects[i];
+            for(auto& o : objs)
+            {
+                if(std::memcmp(&o, &fun, sizeof(fun)) == 0)
+                {
+                    o = objs.back();
+                    objs.pop_back();
+                    --m_size;
+                    if(objs.empty())
+                    {
+                        //an empty group would still be visited by invoke_all and found by group
+                        m_invokers.erase(m_invokers.begin() + i);
+                        m_batches.erase(m_batches.begin() + i);
+                        m_objects.erase(m_objects.begin() + i);
+                    }
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    template <typename T, std::enable_if_t<proper_class<T>, int> = 0>
+    bool remove(const T& obj)
+    {
+        return remove(view_type(obj));
+    }
+
+    template <typename T, std::enable_if_t<std::is_class_v<T> && std::is_invocable_r_v<Ret, T&, Args&&...>, int> = 0>
+    bool remove(use_non_const_type, T& obj)
+    {
+        return remove(view_type(use_non_const, obj));
+    }
+
+    void clear() noexcept
+    {
+        m_invokers.clear();
+        m_batches.clear();
+        m_objects.clear();
+        m_size = 0;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    std::size_t groups() const noexcept
+    {
+        return m_invokers.size();
+    }
+
+    //every callable gets the same arguments, values are copied for each call
+    void invoke_all(Args... args) const
+    {
+        for(std::size_t i = 0; i < m_invokers.size(); ++i)
+        {
+            auto& objs = m_objects[i];
+            if(m_batches[i])
+            {
+                m_batches[i](objs.data(), objs.size(), args...);
+            }
+            else
+            {
+                auto inv = m_invokers[i];
+                for(auto& o : objs)
+                {
+                    inv(o, static_cast<Args>(args)...);
+                }
+            }
+        }
+    }
+};
+
+}
@@ -0,0 +1,279 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+namespace uf_details
+{
+
+struct pool_block
+{
+    pool_block* m_next;
+};
+
+struct pool_central
+{
+    std::mutex m_mutex;
+    pool_block* m_head = nullptr;
+};
+
+}
+
+struct pool_stats
+{
+    //allocations served from recycled blocks
+    std::uint64_t hits;
+    //allocations which went to operator new, including those too large for the pool
+    std::uint64_t misses;
+};
+
+//size class pool for callables which do not fit into the wrappers, select it with pool_policy.
+//each thread keeps a few free blocks per class and trades batches with a shared list,
+//so a block freed on another thread than the one which allocated it is simply reused there.
+//blocks are kept until the program ends
+class func_pool
+{
+    static constexpr std::size_t s_granularity = 64;
+    static constexpr std::size_t s_classes = 16;
+    static constexpr std::size_t s_max_size = s_granularity * s_classes;
+    static constexpr std::size_t s_cache_limit = 64;
+    static constexpr std::size_t s_batch = s_cache_limit / 2;
+
+    using block = uf_details::pool_block;
+
+    struct cache
+    {
+        block* m_heads[s_classes] = {};
+        std::size_t m_counts[s_classes] = {};
+        //only written by the owning thread
+        std::atomic<std::uint64_t> m_hits{0};
+        std::atomic<std::uint64_t> m_misses{0};
+        cache* m_next = nullptr;
+        cache* m_prev = nullptr;
+
+        cache()
+        {
+            std::lock_guard<std::mutex> lock(s_registry_mutex);
+            m_next = s_caches;
+            if(m_next)
+            {
+                m_next->m_prev = this;
+            }
+            s_caches = this;
+        }
+
+        ~cache()
+        {
+            for(std::size_t i = 0; i < s_classes; ++i)
+            {
+                if(m_heads[i])
+                {
+                    s_give(i, m_heads[i]);
+                }
+            }
+            std::lock_guard<std::mutex> lock(s_registry_mutex);
+            s_hits.fetch_add(m_hits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            s_misses.fetch_add(m_misses.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            (m_prev ? m_prev->m_next : s_caches) = m_next;
+            if(m_next)
+            {
+                m_next->m_prev = m_prev;
+            }
+        }
+    };
+
+    //stays valid after the cache of the thread is gone, then the shared lists are used directly
+    struct local
+    {
+        cache* m_cache;
+        bool m_gone;
+    };
+
+    static inline uf_details::pool_central s_central[s_classes];
+    static inline std::mutex s_registry_mutex;
+    static inline cache* s_caches = nullptr;
+    //counts of the threads which are gone, and of those without a cache
+    static inline std::atomic<std::uint64_t> s_hits{0};
+    static inline std::atomic<std::uint64_t> s_misses{0};
+
+    static void s_count(std::atomic<std::uint64_t>& counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static local& s_local_state() noexcept
+    {
+        static thread_local local state{nullptr, false};
+        return state;
+    }
+
+    struct holder
+    {
+        cache m_cache;
+
+        holder()
+        {
+            s_local_state().m_cache = &m_cache;
+        }
+
+        ~holder()
+        {
+            s_local_state() = {nullptr, true};
+        }
+    };
+
+    static cache* s_local()
+    {
+        auto& state = s_local_state();
+        if(state.m_cache || state.m_gone)
+        {
+            return state.m_cache;
+        }
+        static thread_local holder h;
+        return state.m_cache;
+    }
+
+    //hands a list to the shared one of its class
+    static void s_give(std::size_t index, block* head) noexcept
+    {
+        auto tail = head;
+        while(tail->m_next)
+        {
+            tail = tail->m_next;
+        }
+        auto& c = s_central[index];
+        std::lock_guard<std::mutex> lock(c.m_mutex);
+        tail->m_next = c.m_head;
+        c.m_head = head;
+    }
+
+    //takes up to n blocks from the shared list of the class
+    static block* s_take(std::size_t index, std::size_t n, std::size_t& taken) noexcept
+    {
+        auto& c = s_central[index];
+        std::lock_guard<std::mutex> lock(c.m_mutex);
+        auto head = c.m_head;
+        if(!head)
+        {
+            taken = 0;
+            return nullptr;
+        }
+        auto tail = head;
+        for(taken = 1; taken < n && tail->m_next; ++taken)
+        {
+            tail = tail->m_next;
+        }
+        c.m_head = tail->m_next;
+        tail->m_next = nullptr;
+        return head;
+    }
+
+    static bool s_pooled(std::size_t size, std::size_t align) noexcept
+    {
+        return size <= s_max_size && align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    }
+
+public:
+    static void* s_allocate(std::size_t size, std::size_t align)
+    {
+        if(!s_pooled(size, align))
+        {
+            s_misses.fetch_add(1, std::memory_order_relaxed);
+            return new_heap::s_allocate(size, align);
+        }
+        auto index = (size - 1) / s_granularity;
+        auto c = s_local();
+        if(!c)
+        {
+            std::size_t taken;
+            if(auto b = s_take(index, 1, taken))
+            {
+                s_hits.fetch_add(1, std::memory_order_relaxed);
+                return b;
+            }
+            s_misses.fetch_add(1, std::memory_order_relaxed);
+            return ::operator new((index + 1) * s_granularity);
+        }
+        if(!c->m_heads[index])
+        {
+            c->m_heads[index] = s_take(index, s_batch, c->m_counts[index]);
+            if(!c->m_heads[index])
+            {
+                s_count(c->m_misses);
+                return ::operator new((index + 1) * s_granularity);
+            }
+        }
+        auto b = c->m_heads[index];
+        c->m_heads[index] = b->m_next;
+        --c->m_counts[index];
+        s_count(c->m_hits);
+        return b;
+    }
+
+    static void s_deallocate(void* ptr, std::size_t size, std::size_t align) noexcept
+    {
+        if(!s_pooled(size, align))
+        {
+            new_heap::s_deallocate(ptr, size, align);
+            return;
+        }
+        auto index = (size - 1) / s_granularity;
+        auto b = ::new (ptr) block{nullptr};
+        cache* c = nullptr;
+        try
+        {
+            //threads which only ever free, like the consumers of a queue, get a cache as well
+            c = s_local();
+        }
+        catch(...)
+        {
+
+        }
+        if(!c)
+        {
+            s_give(index, b);
+            return;
+        }
+        b->m_next = c->m_heads[index];
+        c->m_heads[index] = b;
+        //keeps half, the rest goes where other threads can find it
+        if(++c->m_counts[index] > s_cache_limit)
+        {
+            auto tail = b;
+            for(std::size_t i = 1; i < s_batch; ++i)
+            {
+                tail = tail->m_next;
+            }
+            auto rest = tail->m_next;
+            tail->m_next = nullptr;
+            s_give(index, rest);
+            c->m_counts[index] = s_batch;
+        }
+    }
+
+    //sums over all threads, approximate while they allocate
+    static pool_stats stats() noexcept
+    {
+        std::lock_guard<std::mutex> lock(s_registry_mutex);
+        pool_stats r{s_hits.load(std::memory_order_relaxed), s_misses.load(std::memory_order_relaxed)};
+        for(auto c = s_caches; c; c = c->m_next)
+        {
+            r.hits += c->m_hits.load(std::memory_order_relaxed);
+            r.misses += c->m_misses.load(std::memory_order_relaxed);
+        }
+        return r;
+    }
+};
+
+struct pool_policy : default_policy
+{
+    using heap = func_pool;
+};
+
+}
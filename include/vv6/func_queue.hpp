@@ -0,0 +1,229 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+//bounded lock-free multi producer multi consumer queue
+//callables are constructed right into the slots and invoked from there,
+//no intermediate wrapper is moved in or out
+template <typename Sig, std::size_t Size = default_capacity, std::size_t Align = default_alignment,
+          typename Policy = default_policy>
+class func_queue
+{
+public:
+    using value_type = basic_unique_func<Sig, Size, Align, Policy>;
+
+private:
+    //keeps the producer and the consumer indices off each other's cache line
+    static constexpr std::size_t s_cache_line = 64;
+
+    struct slot
+    {
+        std::atomic<std::size_t> m_sequence;
+        value_type m_func;
+    };
+
+    std::unique_ptr<slot[]> m_slots;
+    std::size_t m_mask;
+    alignas(s_cache_line) std::atomic<std::size_t> m_enqueue;
+    alignas(s_cache_line) std::atomic<std::size_t> m_dequeue;
+
+    static std::size_t s_round_up(std::size_t n) noexcept
+    {
+        std::size_t r = 2;
+        while(r < n)
+        {
+            r <<= 1;
+        }
+        return r;
+    }
+
+    slot* acquire_push(std::size_t& pos) noexcept
+    {
+        pos = m_enqueue.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            slot* s = &m_slots[pos & m_mask];
+            auto diff = static_cast<std::intptr_t>(s->m_sequence.load(std::memory_order_acquire)) -
+                    static_cast<std::intptr_t>(pos);
+            if(diff == 0)
+            {
+                if(m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    return s;
+                }
+            }
+            else if(diff < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                pos = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    slot* acquire_pop(std::size_t& pos) noexcept
+    {
+        pos = m_dequeue.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            slot* s = &m_slots[pos & m_mask];
+            auto diff = static_cast<std::intptr_t>(s->m_sequence.load(std::memory_order_acquire)) -
+                    static_cast<std::intptr_t>(pos + 1);
+            if(diff == 0)
+            {
+                if(m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    return s;
+                }
+            }
+            else if(diff < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                pos = m_dequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //the slot is published even if the construction throws, consumers skip empty ones
+    struct push_guard
+    {
+        slot* m_slot;
+        std::size_t m_pos;
+
+        ~push_guard()
+        {
+            m_slot->m_sequence.store(m_pos + 1, std::memory_order_release);
+        }
+    };
+
+    struct pop_guard
+    {
+        slot* m_slot;
+        std::size_t m_pos;
+        std::size_t m_size;
+
+        ~pop_guard()
+        {
+            m_slot->m_func.reset();
+            m_slot->m_sequence.store(m_pos + m_size, std::memory_order_release);
+        }
+    };
+
+public:
+    explicit func_queue(std::size_t capacity) :
+        m_slots(new slot[s_round_up(capacity)]), m_mask(s_round_up(capacity) - 1), m_enqueue(0), m_dequeue(0)
+    {
+        for(std::size_t i = 0; i <= m_mask; ++i)
+        {
+            m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    func_queue(const func_queue&) = delete;
+    func_queue& operator=(const func_queue&) = delete;
+
+    std::size_t capacity() const noexcept
+    {
+        return m_mask + 1;
+    }
+
+    //approximate while other threads are pushing or popping
+    std::size_t size() const noexcept
+    {
+        auto e = m_enqueue.load(std::memory_order_relaxed);
+        auto d = m_dequeue.load(std::memory_order_relaxed);
+        return e > d ? e - d : 0;
+    }
+
+    template <typename T, typename... TArgs>
+    bool try_emplace(TArgs&&... args)
+    {
+        std::size_t pos;
+        slot* s = acquire_push(pos);
+        if(!s)
+        {
+            return false;
+        }
+        push_guard g{s, pos};
+        s->m_func.template emplace<T>(std::forward<TArgs>(args)...);
+        return true;
+    }
+
+    template <typename T>
+    bool try_push(T&& t)
+    {
+        using DT = std::decay_t<T>;
+        //wrappers are adopted, anything else is built in the slot
+        if constexpr(std::is_same_v<DT, value_type> ||
+                     !std::is_constructible_v<value_type, std::in_place_type_t<DT>, T&&>)
+        {
+            std::size_t pos;
+            slot* s = acquire_push(pos);
+            if(!s)
+            {
+                return false;
+            }
+            push_guard g{s, pos};
+            s->m_func = value_type(std::forward<T>(t));
+            return true;
+        }
+        else
+        {
+            return try_emplace<DT>(std::forward<T>(t));
+        }
+    }
+
+    bool try_pop(value_type& out)
+    {
+        for(;;)
+        {
+            std::size_t pos;
+            slot* s = acquire_pop(pos);
+            if(!s)
+            {
+                return false;
+            }
+            pop_guard g{s, pos, capacity()};
+            if(s->m_func)
+            {
+                out = std::move(s->m_func);
+                return true;
+            }
+        }
+    }
+
+    //invokes the callable in its slot and destroys it there
+    template <typename... A>
+    bool try_invoke(A&&... args)
+    {
+        for(;;)
+        {
+            std::size_t pos;
+            slot* s = acquire_pop(pos);
+            if(!s)
+            {
+                return false;
+            }
+            pop_guard g{s, pos, capacity()};
+            if(s->m_func)
+            {
+                s->m_func(std::forward<A>(args)...);
+                return true;
+            }
+        }
+    }
+};
+
+}
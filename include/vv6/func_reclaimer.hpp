@@ -0,0 +1,275 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+//takes the destruction of callables off the threads which let go of them, select it with deferred_policy.
+//a wrapper which is destroyed, reset or assigned to moves its callable into a batch of the current thread,
+//one on the heap only hands over its pointer. drain destroys the batch of the calling thread,
+//flush passes it on to collect, which may run on a thread of its own.
+//an exiting thread destroys what is left in its batch, and a callable the batch has no memory for is destroyed right away
+class func_reclaimer
+{
+    static constexpr std::size_t s_align = default_alignment;
+    static constexpr std::size_t s_chunk_capacity = 4096;
+
+    struct entry
+    {
+        uf_details::manager_type m_manage;
+        //from the entry to the object and to the next entry
+        std::uint32_t m_offset;
+        std::uint32_t m_next;
+    };
+
+    static constexpr std::size_t s_align_up(std::size_t n, std::size_t align) noexcept
+    {
+        return (n + align - 1) & ~(align - 1);
+    }
+
+    //a batch is a list of chunks, the callables are packed into them back to back and never move
+    struct chunk
+    {
+        chunk* m_next;
+        std::size_t m_size;
+        std::size_t m_capacity;
+
+        std::byte* data() noexcept
+        {
+            return reinterpret_cast<std::byte*>(this) + s_chunk_header;
+        }
+    };
+
+    static constexpr std::size_t s_chunk_header = (sizeof(chunk) + s_align - 1) & ~(s_align - 1);
+
+    struct local
+    {
+        chunk* m_head;
+        chunk* m_tail;
+        //a drained chunk kept for the next batch
+        chunk* m_spare;
+        std::size_t m_count;
+        bool m_gone;
+    };
+
+    //what nobody collected is destroyed when the program ends
+    struct shared
+    {
+        std::mutex m_mutex;
+        chunk* m_head;
+        chunk* m_tail;
+
+        shared() noexcept :
+            m_head(nullptr), m_tail(nullptr)
+        {
+
+        }
+
+        ~shared()
+        {
+            s_destroy(m_head, nullptr);
+        }
+    };
+
+    static inline shared s_shared;
+
+    static local& s_local_state() noexcept
+    {
+        static thread_local local state{nullptr, nullptr, nullptr, 0, false};
+        return state;
+    }
+
+    struct holder
+    {
+        ~holder()
+        {
+            auto& state = s_local_state();
+            //destroying a callable may retire more
+            while(state.m_head)
+            {
+                drain();
+            }
+            if(state.m_spare)
+            {
+                s_deallocate(state.m_spare);
+            }
+            state = {nullptr, nullptr, nullptr, 0, true};
+        }
+    };
+
+    static chunk* s_allocate(std::size_t capacity)
+    {
+        auto p = new_heap::s_allocate(s_chunk_header + capacity, s_align);
+        return ::new (p) chunk{nullptr, 0, capacity};
+    }
+
+    static void s_deallocate(chunk* c) noexcept
+    {
+        new_heap::s_deallocate(c, s_chunk_header + c->m_capacity, s_align);
+    }
+
+    //destroys the callables in order and frees the chunks, the first one of the usual size may be kept
+    static std::size_t s_destroy(chunk* c, chunk** spare) noexcept
+    {
+        std::size_t n = 0;
+        while(c)
+        {
+            for(std::size_t pos = 0; pos < c->m_size; ++n)
+            {
+                auto e = uf_details::launder_cast<entry*>(c->data() + pos);
+                e->m_manage(uf_details::manage_op::destroy, c->data() + pos + e->m_offset, nullptr);
+                pos += e->m_next;
+            }
+            auto next = c->m_next;
+            if(spare && !*spare && c->m_capacity == s_chunk_capacity)
+            {
+                c->m_next = nullptr;
+                c->m_size = 0;
+                *spare = c;
+            }
+            else
+            {
+                s_deallocate(c);
+            }
+            c = next;
+        }
+        return n;
+    }
+
+    //appends a chunk with room for at least capacity bytes to the batch
+    static chunk* s_extend(local& state, std::size_t capacity) noexcept
+    {
+        chunk* c = nullptr;
+        try
+        {
+            //the first chunk of a thread makes sure its batch is destroyed when it exits
+            static thread_local holder h;
+            if(state.m_spare && capacity <= s_chunk_capacity)
+            {
+                c = std::exchange(state.m_spare, nullptr);
+            }
+            else
+            {
+                c = s_allocate(std::max(capacity, s_chunk_capacity));
+            }
+        }
+        catch(...)
+        {
+            return nullptr;
+        }
+        (state.m_tail ? state.m_tail->m_next : state.m_head) = c;
+        state.m_tail = c;
+        return c;
+    }
+
+    //room for an object at the end of the batch of this thread, null when there is none
+    static void* s_place(uf_details::manager_type manage, std::size_t size, std::size_t align) noexcept
+    {
+        auto& state = s_local_state();
+        if(state.m_gone || align > s_align)
+        {
+            return nullptr;
+        }
+        auto c = state.m_tail;
+        auto pos = c ? c->m_size : 0;
+        auto offset = s_align_up(pos + sizeof(entry), align) - pos;
+        auto next = s_align_up(offset + size, alignof(entry));
+        if(!c || c->m_capacity - pos < next)
+        {
+            pos = 0;
+            offset = s_align_up(sizeof(entry), align);
+            next = s_align_up(offset + size, alignof(entry));
+            c = s_extend(state, next);
+            if(!c)
+            {
+                return nullptr;
+            }
+        }
+        ::new (c->data() + pos) entry{manage, static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(next)};
+        c->m_size += next;
+        ++state.m_count;
+        return c->data() + pos + offset;
+    }
+
+public:
+    //the hook of the wrappers, the storage is left without an object
+    static void s_retire(uf_details::manager_type manage, bool relocatable,
+                         void* storage, std::size_t size, std::size_t align) noexcept
+    {
+        auto p = s_place(manage, size, align);
+        if(!p)
+        {
+            manage(uf_details::manage_op::destroy, storage, nullptr);
+        }
+        else if(relocatable)
+        {
+            std::memcpy(p, storage, size);
+        }
+        else
+        {
+            manage(uf_details::manage_op::move, storage, p);
+        }
+    }
+
+    //destroys the batch of this thread, what the callables retire meanwhile waits for the next batch.
+    //returns how many were destroyed
+    static std::size_t drain() noexcept
+    {
+        auto& state = s_local_state();
+        auto head = std::exchange(state.m_head, nullptr);
+        state.m_tail = nullptr;
+        state.m_count = 0;
+        return s_destroy(head, &state.m_spare);
+    }
+
+    //passes the batch of this thread on to collect
+    static void flush() noexcept
+    {
+        auto& state = s_local_state();
+        if(!state.m_head)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(s_shared.m_mutex);
+            (s_shared.m_tail ? s_shared.m_tail->m_next : s_shared.m_head) = state.m_head;
+            s_shared.m_tail = state.m_tail;
+        }
+        state.m_head = nullptr;
+        state.m_tail = nullptr;
+        state.m_count = 0;
+    }
+
+    //destroys the batches flushed so far, then the batch of the calling thread
+    static std::size_t collect() noexcept
+    {
+        chunk* head;
+        {
+            std::lock_guard<std::mutex> lock(s_shared.m_mutex);
+            head = std::exchange(s_shared.m_head, nullptr);
+            s_shared.m_tail = nullptr;
+        }
+        auto n = s_destroy(head, nullptr);
+        return n + drain();
+    }
+
+    //callables in the batch of this thread
+    static std::size_t pending() noexcept
+    {
+        return s_local_state().m_count;
+    }
+};
+
+struct deferred_policy : default_policy
+{
+    using reclaimer = func_reclaimer;
+};
+
+}
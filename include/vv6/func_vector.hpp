@@ -0,0 +1,367 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+template <typename Sig>
+class func_vector;
+
+namespace uf_details
+{
+
+//the callables are packed into a single buffer, each behind a header which tells how to call,
+//move and destroy it and where the next one starts. positions are kept when the buffer grows,
+//so whatever was aligned stays aligned. while invoke_all runs the buffer does not move: if it has to grow,
+//what is added goes to its place in the next buffer and the rest follows once the outermost walk is over
+template <typename Sig>
+class func_vector_base;
+
+template <typename Ret, typename... Args>
+class func_vector_base<Ret(Args...)>
+{
+    using invoker_type = typename erased_invoker<Ret(Args...)>::type;
+
+    struct header
+    {
+        invoker_type m_invoker;
+        //null for objects which need neither a destructor nor a move constructor
+        const manager_entry* m_manager;
+        //from the header to the object and to the next header
+        std::uint32_t m_offset;
+        std::uint32_t m_next;
+    };
+
+    static constexpr std::size_t s_align = default_alignment;
+    static constexpr std::size_t s_min_capacity = 256;
+
+    std::byte* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::size_t m_capacity = 0;
+    std::size_t m_count = 0;
+    //the walks running, and the buffer which takes over after them, holding what lies past m_split
+    mutable std::size_t m_walks = 0;
+    std::byte* m_next_data = nullptr;
+    std::size_t m_next_capacity = 0;
+    std::size_t m_split = 0;
+    //every object can be moved with memcpy, and every one can be dropped without a destructor
+    bool m_relocatable = true;
+    bool m_trivial = true;
+
+    static constexpr std::size_t s_align_up(std::size_t n, std::size_t align) noexcept
+    {
+        return (n + align - 1) & ~(align - 1);
+    }
+
+    static const header& s_header(const std::byte* p) noexcept
+    {
+        return *launder_cast<const header*>(p);
+    }
+
+    //the objects between the two positions, to the same positions in dst
+    void relocate(std::byte* src, std::byte* dst, std::size_t from, std::size_t to) noexcept
+    {
+        if(m_relocatable)
+        {
+            if(to != from)
+            {
+                std::memcpy(dst + from, src + from, to - from);
+            }
+            return;
+        }
+        for(std::size_t pos = from; pos < to;)
+        {
+            auto& h = s_header(src + pos);
+            new (dst + pos) header(h);
+            if(h.m_manager && !h.m_manager->relocatable)
+            {
+                h.m_manager->manage(manage_op::move, src + pos + h.m_offset, dst + pos + h.m_offset);
+            }
+            else
+            {
+                std::memcpy(dst + pos + h.m_offset, src + pos + h.m_offset, h.m_next - h.m_offset);
+            }
+            pos += h.m_next;
+        }
+    }
+
+    void destroy_all() noexcept
+    {
+        if(m_trivial)
+        {
+            return;
+        }
+        for(std::size_t pos = 0; pos < m_size;)
+        {
+            auto& h = s_header(m_data + pos);
+            if(h.m_manager)
+            {
+                h.m_manager->manage(manage_op::destroy, m_data + pos + h.m_offset, nullptr);
+            }
+            pos += h.m_next;
+        }
+    }
+
+    void release() noexcept
+    {
+        if(m_data)
+        {
+            new_heap::s_deallocate(m_data, m_capacity, s_align);
+        }
+    }
+
+    void grow(std::size_t capacity)
+    {
+        auto data = static_cast<std::byte*>(new_heap::s_allocate(capacity, s_align));
+        if(m_walks == 0)
+        {
+            relocate(m_data, data, 0, m_size);
+            release();
+            m_data = data;
+            m_capacity = capacity;
+        }
+        else if(!m_next_data)
+        {
+            m_next_data = data;
+            m_next_capacity = capacity;
+            m_split = m_size;
+        }
+        else
+        {
+            relocate(m_next_data, data, m_split, m_size);
+            new_heap::s_deallocate(m_next_data, m_next_capacity, s_align);
+            m_next_data = data;
+            m_next_capacity = capacity;
+        }
+    }
+
+    //once the walks are over, the front part follows what was added meanwhile
+    void leave_walk() noexcept
+    {
+        if(--m_walks == 0 && m_next_data)
+        {
+            relocate(m_data, m_next_data, 0, m_split);
+            release();
+            m_data = std::exchange(m_next_data, nullptr);
+            m_capacity = m_next_capacity;
+        }
+    }
+
+    struct walk
+    {
+        func_vector_base* m_self;
+
+        ~walk()
+        {
+            m_self->leave_walk();
+        }
+    };
+
+protected:
+    template <typename CallSig, typename T, typename... TArgs>
+    T& construct(TArgs&& ...args)
+    {
+        static_assert(alignof(T) <= s_align, "over-aligned callables are not supported");
+        static_assert(std::is_nothrow_move_constructible_v<T> || is_trivially_relocatable_v<T>,
+                      "the callables are moved when the buffer grows, that must not throw");
+        auto offset = s_align_up(m_size + sizeof(header), alignof(T)) - m_size;
+        auto next = s_align_up(offset + sizeof(T), alignof(header));
+        if(capacity() - m_size < next)
+        {
+            grow(std::max(2 * capacity(), std::max(m_size + next, s_min_capacity)));
+        }
+        auto p = (m_next_data ? m_next_data : m_data) + m_size;
+        auto obj = new (p + offset) T(std::forward<TArgs>(args)...);
+        constexpr bool relocatable = is_trivially_relocatable_v<T>;
+        constexpr bool trivial = relocatable && std::is_trivially_destructible_v<T>;
+        const manager_entry* manager = nullptr;
+        if constexpr(!trivial)
+        {
+            manager = &manager_entry_for<internal_manager<T>::s_manage, relocatable>::value;
+        }
+        new (p) header{invoker_of<CallSig, T, false>::value, manager,
+                       static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(next)};
+        m_size += next;
+        ++m_count;
+        m_relocatable = m_relocatable && relocatable;
+        m_trivial = m_trivial && trivial;
+        return *obj;
+    }
+
+    //what is added meanwhile is not called
+    template <bool NE>
+    void call_all(std::remove_reference_t<Args>&... args) const noexcept(NE)
+    {
+        //a callable which adds to a const one had it through another path, the vector itself is not const
+        ++m_walks;
+        walk guard{const_cast<func_vector_base*>(this)};
+        auto data = m_data;
+        auto size = m_next_data ? m_split : m_size;
+        for(std::size_t pos = 0; pos < size;)
+        {
+            auto& h = s_header(data + pos);
+            const void* obj = data + pos + h.m_offset;
+            if constexpr(NE)
+            {
+                using type = typename restore_noexcept<invoker_type>::type;
+                reinterpret_cast<type>(h.m_invoker)(obj, static_cast<Args>(args)...);
+            }
+            else
+            {
+                h.m_invoker(obj, static_cast<Args>(args)...);
+            }
+            pos += h.m_next;
+        }
+    }
+
+public:
+    func_vector_base() noexcept = default;
+
+    func_vector_base(func_vector_base&& other) noexcept :
+        m_data(std::exchange(other.m_data, nullptr)),
+        m_size(std::exchange(other.m_size, 0)),
+        m_capacity(std::exchange(other.m_capacity, 0)),
+        m_count(std::exchange(other.m_count, 0)),
+        m_relocatable(std::exchange(other.m_relocatable, true)),
+        m_trivial(std::exchange(other.m_trivial, true))
+    {
+
+    }
+
+    func_vector_base& operator=(func_vector_base&& other) noexcept
+    {
+        if(this != &other)
+        {
+            destroy_all();
+            release();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_capacity = std::exchange(other.m_capacity, 0);
+            m_count = std::exchange(other.m_count, 0);
+            m_relocatable = std::exchange(other.m_relocatable, true);
+            m_trivial = std::exchange(other.m_trivial, true);
+        }
+        return *this;
+    }
+
+    ~func_vector_base()
+    {
+        destroy_all();
+        release();
+    }
+
+    //destroys the callables and keeps the buffer, without touching them if none needs a destructor.
+    //not while invoke_all runs
+    void clear() noexcept
+    {
+        destroy_all();
+        m_size = 0;
+        m_count = 0;
+        m_relocatable = true;
+        m_trivial = true;
+    }
+
+    //in bytes, headers included
+    void reserve(std::size_t bytes)
+    {
+        if(bytes > capacity())
+        {
+            grow(bytes);
+        }
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_count;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_count == 0;
+    }
+
+    std::size_t bytes() const noexcept
+    {
+        return m_size;
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return m_next_data ? m_next_capacity : m_capacity;
+    }
+};
+
+}
+
+//move-only sequence of callables stored back to back in one buffer, headers included.
+//there is no per-element allocation and no capacity per element, a capture-less lambda takes 32 bytes.
+//callables are only reachable through invoke_all, in insertion order. they may add to the vector while called
+template <typename Ret, typename... Args, bool NE>
+class func_vector<Ret(Args...) noexcept(NE)> : public uf_details::func_vector_base<Ret(Args...)>
+{
+    static_assert((!std::is_rvalue_reference_v<Args> && ...),
+                  "func_vector cannot hand the same rvalue to several callables");
+
+    using signature_type = Ret(Args...) noexcept(NE);
+    using base_type = uf_details::func_vector_base<Ret(Args...)>;
+
+    template <typename T>
+    static constexpr bool proper = details::invocable_r<NE, Ret, T&, Args&&...>;
+public:
+    template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    void push_back(T&& t)
+    {
+        base_type::template construct<signature_type, std::decay_t<T>>(std::forward<T>(t));
+    }
+
+    template <typename T, typename... TArgs, std::enable_if_t<proper<T>, int> = 0>
+    T& emplace_back(TArgs&& ...args)
+    {
+        return base_type::template construct<signature_type, T>(std::forward<TArgs>(args)...);
+    }
+
+    //every callable gets the same arguments, values are copied for each call
+    void invoke_all(Args... args) noexcept(NE)
+    {
+        base_type::template call_all<NE>(args...);
+    }
+};
+
+template <typename Ret, typename... Args, bool NE>
+class func_vector<Ret(Args...) const noexcept(NE)> : public uf_details::func_vector_base<Ret(Args...)>
+{
+    static_assert((!std::is_rvalue_reference_v<Args> && ...),
+                  "func_vector cannot hand the same rvalue to several callables");
+
+    using signature_type = Ret(Args...) const noexcept(NE);
+    using base_type = uf_details::func_vector_base<Ret(Args...)>;
+
+    template <typename T>
+    static constexpr bool proper = details::invocable_r<NE, Ret, const T&, Args&&...>;
+public:
+    template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    void push_back(T&& t)
+    {
+        base_type::template construct<signature_type, std::decay_t<T>>(std::forward<T>(t));
+    }
+
+    template <typename T, typename... TArgs, std::enable_if_t<proper<T>, int> = 0>
+    T& emplace_back(TArgs&& ...args)
+    {
+        return base_type::template construct<signature_type, T>(std::forward<TArgs>(args)...);
+    }
+
+    void invoke_all(Args... args) const noexcept(NE)
+    {
+        base_type::template call_all<NE>(args...);
+    }
+};
+
+}
@@ -1,5 +1,7 @@
 #pragma once
+#include <cstddef>
 #include <cstdlib>
+#include <tuple>
 #include <utility>
 #include <type_traits>
 
@@ -9,6 +11,30 @@ namespace vv6
 template <typename Sig>
 class func_view;
 
+//several signatures over one callable, e.g. func_view<overload<void(int), void()>>
+template <typename... Sigs>
+struct overload {};
+
+//the largest trivially copyable argument the trampolines take by value, anything else goes by reference.
+//the System V x86-64 and AArch64 conventions pass two registers worth of such a type in registers,
+//Windows x64 passes anything larger than one register through memory anyway
+#ifdef VV6_PASS_BY_VALUE_SIZE
+inline constexpr std::size_t pass_by_value_size = VV6_PASS_BY_VALUE_SIZE;
+#elif (defined(__x86_64__) && !defined(_WIN32)) || defined(__aarch64__)
+inline constexpr std::size_t pass_by_value_size = 2 * sizeof(void*);
+#else
+inline constexpr std::size_t pass_by_value_size = sizeof(void*);
+#endif
+
+//whether the trampolines take a T by value, specialize it to decide for a type of your own.
+//a type taken by value is moved into the trampoline, so that should be cheap
+template <typename T>
+struct pass_by_value : std::bool_constant<std::is_object_v<T> &&
+        std::is_trivially_copy_constructible_v<T> &&
+        std::is_trivially_move_constructible_v<T> &&
+        std::is_trivially_destructible_v<T> &&
+        (sizeof(T) <= pass_by_value_size)> {};
+
 namespace details
 {
 
@@ -35,49 +61,50 @@ decltype(auto) functor_cast(functor fun)
     }
 }
 
-template <typename T>
-struct pass_by_value
-{
-    static constexpr bool value = std::is_object_v<T> &&
-            std::is_trivially_copy_constructible_v<T> &&
-            std::is_trivially_move_constructible_v<T> &&
-            std::is_trivially_destructible_v<T> &&
-            (sizeof(T) <= sizeof(void*));
-};
-
 template <typename T>
 using argument_t = std::conditional_t<pass_by_value<T>::value, T, T&&>;
 
 template <typename Sig, typename T, bool Const>
 struct invoker;
 
-template <typename Ret, typename... Args, typename T, bool Const>
-struct invoker<Ret(Args...), T, Const>
+struct func_view_access;
+
+template <typename Ret, typename... Args, bool NE, typename T, bool Const>
+struct invoker<Ret(Args...) noexcept(NE), T, Const>
 {
-    static Ret s_invoke(functor fun, argument_t<Args>... args)
+    static Ret s_invoke(functor fun, argument_t<Args>... args) noexcept(NE)
     {
         return static_cast<Ret>(functor_cast<T, Const>(fun)(std::forward<Args>(args)...));
     }
 };
+
+//noexcept signatures only accept targets which cannot throw
+template <bool NE, typename Ret, typename F, typename... Args>
+inline constexpr bool invocable_r = NE ? std::is_nothrow_invocable_r_v<Ret, F, Args...> :
+                                         std::is_invocable_r_v<Ret, F, Args...>;
 }
 
 struct use_non_const_type {};
 inline use_non_const_type use_non_const;
 
-template <typename Ret, typename ...Args>
-class func_view<Ret(Args...)>
+template <typename Ret, typename ...Args, bool NE>
+class func_view<Ret(Args...) noexcept(NE)>
 {
+    template <typename>
+    friend class func_view;
+    friend struct details::func_view_access;
+
     details::functor m_functor;
-    Ret( *m_invoker)(details::functor, details::argument_t<Args>...);
+    Ret( *m_invoker)(details::functor, details::argument_t<Args>...) noexcept(NE);
 
     template <typename T>
     static constexpr bool proper_class = std::is_class_v<T> &&
             !std::is_convertible_v<T*, func_view*> &&
-            std::is_invocable_r_v<Ret, const T&, Args&&...>;
+            details::invocable_r<NE, Ret, const T&, Args&&...>;
 
     template <typename T>
     static constexpr bool proper_non_const_class = std::is_class_v<T> &&
-            std::is_invocable_r_v<Ret, T&, Args&&...>;
+            details::invocable_r<NE, Ret, T&, Args&&...>;
 
 public:
     constexpr func_view() noexcept :
@@ -86,8 +113,16 @@ public:
 
     }
 
+    //from noexcept to potentially throwing only
+    template <bool ONE, std::enable_if_t<ONE && !NE, int> = 0>
+    constexpr func_view(const func_view<Ret(Args...) noexcept(ONE)>& other) noexcept :
+        m_functor(other.m_functor), m_invoker(other.m_invoker)
+    {
+
+    }
+
     template <typename T, std::enable_if_t<proper_class<std::decay_t<T>>, int> = 0>
-    constexpr func_view(const T& obj) noexcept :m_invoker(details::invoker<Ret(Args...), T, true>::s_invoke)
+    constexpr func_view(const T& obj) noexcept :m_invoker(&details::invoker<Ret(Args...) noexcept(NE), T, true>::s_invoke)
     {
         m_functor.obj = &obj;
     }
@@ -97,21 +132,21 @@ public:
 
     template <typename T, std::enable_if_t<proper_non_const_class<std::decay_t<T>> && !std::is_const_v<T>, int> = 0>
     constexpr func_view(use_non_const_type, T& obj) noexcept :
-        m_invoker(details::invoker<Ret(Args...), T, false>::s_invoke)
+        m_invoker(&details::invoker<Ret(Args...) noexcept(NE), T, false>::s_invoke)
     {
         m_functor.obj = &obj;
     }
 
     template <typename T,
-                  std::enable_if_t<std::is_function_v<std::remove_pointer_t<T>> && std::is_invocable_r_v<Ret, T, Args&&...>,
+                  std::enable_if_t<std::is_function_v<std::remove_pointer_t<T>> && details::invocable_r<NE, Ret, T, Args&&...>,
                                    int> = 0>
     constexpr func_view(T t) noexcept :
-        m_invoker(details::invoker<Ret(Args...), std::remove_pointer_t<T>, true>::s_invoke)
+        m_invoker(&details::invoker<Ret(Args...) noexcept(NE), std::remove_pointer_t<T>, true>::s_invoke)
     {
         m_functor.fun = reinterpret_cast<void(*)()>(t);
     }
 
-    Ret operator()(Args&&... args) const
+    Ret operator()(Args&&... args) const noexcept(NE)
     {
         return m_invoker(m_functor, std::forward<Args>(args)...);
     }
@@ -122,4 +157,140 @@ public:
     }
 };
 
+namespace details
+{
+
+template <typename Sig>
+struct view_invoker;
+
+template <typename Ret, typename... Args, bool NE>
+struct view_invoker<Ret(Args...) noexcept(NE)>
+{
+    using type = Ret(*)(functor, argument_t<Args>...) noexcept(NE);
+};
+
+//a variable template trips gcc 12 on noexcept signatures
+template <typename T, bool Const, typename... Sigs>
+struct overload_table
+{
+    static constexpr std::tuple<typename view_invoker<Sigs>::type...> value{&invoker<Sigs, T, Const>::s_invoke...};
+};
+
+template <typename Derived, std::size_t I, typename Sig>
+struct overload_view_call;
+
+template <typename Derived, std::size_t I, typename Ret, typename... Args, bool NE>
+struct overload_view_call<Derived, I, Ret(Args...) noexcept(NE)>
+{
+    Ret operator()(Args&&... args) const noexcept(NE)
+    {
+        return static_cast<const Derived&>(*this).template call<I>(std::forward<Args>(args)...);
+    }
+};
+
+template <typename Derived, typename Indices, typename... Sigs>
+struct overload_view_calls;
+
+template <typename Derived, std::size_t... I, typename... Sigs>
+struct overload_view_calls<Derived, std::index_sequence<I...>, Sigs...> : overload_view_call<Derived, I, Sigs>...
+{
+    using overload_view_call<Derived, I, Sigs>::operator()...;
+};
+
+}
+
+//one object pointer and one table of invokers, however many signatures there are
+template <typename... Sigs>
+class func_view<overload<Sigs...>> :
+        public details::overload_view_calls<func_view<overload<Sigs...>>, std::index_sequence_for<Sigs...>, Sigs...>
+{
+    template <typename, std::size_t, typename>
+    friend struct details::overload_view_call;
+
+    using table_type = std::tuple<typename details::view_invoker<Sigs>::type...>;
+
+    details::functor m_functor;
+    const table_type* m_table;
+
+    template <typename T, typename Sig>
+    struct invocable;
+
+    template <typename T, typename Ret, typename... Args, bool NE>
+    struct invocable<T, Ret(Args...) noexcept(NE)> : std::bool_constant<details::invocable_r<NE, Ret, T, Args&&...>> {};
+
+    template <typename T>
+    static constexpr bool proper_class = std::is_class_v<T> &&
+            !std::is_convertible_v<T*, func_view*> &&
+            (invocable<const T&, Sigs>::value && ...);
+
+    template <typename T>
+    static constexpr bool proper_non_const_class = std::is_class_v<T> &&
+            (invocable<T&, Sigs>::value && ...);
+
+    template <std::size_t I, typename... Args>
+    decltype(auto) call(Args&&... args) const
+    {
+        return std::get<I>(*m_table)(m_functor, std::forward<Args>(args)...);
+    }
+
+public:
+    constexpr func_view() noexcept :
+        m_functor(), m_table()
+    {
+
+    }
+
+    template <typename T, std::enable_if_t<proper_class<std::decay_t<T>>, int> = 0>
+    constexpr func_view(const T& obj) noexcept :
+        m_table(&details::overload_table<T, true, Sigs...>::value)
+    {
+        m_functor.obj = &obj;
+    }
+
+    template <typename T, std::enable_if_t<proper_class<std::decay_t<T>>, int> = 0>
+    constexpr func_view(const T&& obj) noexcept = delete;
+
+    template <typename T, std::enable_if_t<proper_non_const_class<std::decay_t<T>> && !std::is_const_v<T>, int> = 0>
+    constexpr func_view(use_non_const_type, T& obj) noexcept :
+        m_table(&details::overload_table<T, false, Sigs...>::value)
+    {
+        m_functor.obj = &obj;
+    }
+
+    explicit constexpr operator bool() const noexcept
+    {
+        return m_table != nullptr;
+    }
+};
+
+namespace details
+{
+
+//for owners which keep the functor and the invoker on their own
+struct func_view_access
+{
+    template <typename Ret, typename... Args, bool NE>
+    static constexpr functor get_functor(const func_view<Ret(Args...) noexcept(NE)>& f) noexcept
+    {
+        return f.m_functor;
+    }
+
+    template <typename Ret, typename... Args, bool NE>
+    static constexpr auto get_invoker(const func_view<Ret(Args...) noexcept(NE)>& f) noexcept
+    {
+        return f.m_invoker;
+    }
+
+    template <typename Sig, typename Invoker>
+    static constexpr func_view<Sig> make(functor fun, Invoker inv) noexcept
+    {
+        func_view<Sig> f;
+        f.m_functor = fun;
+        f.m_invoker = inv;
+        return f;
+    }
+};
+
+}
+
 }
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+//never allocates, callables which do not fit are rejected at compile time
+template <typename Sig, std::size_t Capacity = default_capacity, std::size_t Align = default_alignment,
+          typename Policy = default_policy>
+class inplace_func;
+
+namespace uf_details
+{
+
+template <typename T, std::size_t Capacity, std::size_t Align>
+constexpr void check_inplace()
+{
+    static_assert(is_inplace<T, basic_storage<Capacity, Align>>,
+                  "inplace_func requires the callable to fit into its capacity and alignment, "
+                  "and to be nothrow move constructible");
+}
+
+}
+
+template <typename Ret, typename... Args, std::size_t Capacity, std::size_t Align, typename Policy>
+class inplace_func<Ret(Args...), Capacity, Align, Policy> : public uf_details::unique_func_base<Ret(Args...), Capacity, Align, Policy>
+{
+    using signature_type = Ret(Args ...);
+    using base_type = uf_details::unique_func_base<Ret(Args...), Capacity, Align, Policy>;
+
+    //other wrappers may own heap memory
+    template <std::size_t OCapacity, std::size_t OAlign, typename OPolicy>
+    static std::true_type s_erased(const uf_details::unique_func_base<Ret(Args...), OCapacity, OAlign, OPolicy>*);
+    static std::false_type s_erased(...);
+
+    template <typename T>
+    static constexpr bool proper = !std::is_convertible_v<T*, inplace_func*> &&
+            !decltype(s_erased(std::declval<T*>()))::value &&
+            std::is_invocable_r_v<Ret, T&, Args&&...>;
+public:
+    using base_type::base_type;
+
+    template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    inplace_func(T&& t) noexcept(std::is_nothrow_constructible_v<std::decay_t<T>, T&&>)
+    {
+        uf_details::check_inplace<std::decay_t<T>, Capacity, Align>();
+        base_type::template construct<signature_type, std::decay_t<T>>(this, std::forward<T>(t));
+    }
+
+    template <typename T, typename... DTArgs, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    inplace_func(std::in_place_type_t<T>, DTArgs&&... args) noexcept(std::is_nothrow_constructible_v<T, DTArgs&&...>)
+    {
+        uf_details::check_inplace<T, Capacity, Align>();
+        base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
+    }
+
+    template <std::size_t OCapacity, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OCapacity, OAlign>, int> = 0>
+    inplace_func(inplace_func<Ret(Args...), OCapacity, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    template <std::size_t OCapacity, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OCapacity, OAlign>, int> = 0>
+    inplace_func(inplace_func<Ret(Args...) const, OCapacity, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    Ret operator()(Args&& ...args)
+    {
+        return base_type::call(std::forward<Args>(args)...);
+    }
+};
+
+template <typename Ret, typename... Args, std::size_t Capacity, std::size_t Align, typename Policy>
+class inplace_func<Ret(Args...) const, Capacity, Align, Policy> : public uf_details::unique_func_base<Ret(Args...), Capacity, Align, Policy>
+{
+    using signature_type = Ret(Args ...) const;
+    using base_type = uf_details::unique_func_base<Ret(Args...), Capacity, Align, Policy>;
+
+    //other wrappers may own heap memory
+    template <std::size_t OCapacity, std::size_t OAlign, typename OPolicy>
+    static std::true_type s_erased(const uf_details::unique_func_base<Ret(Args...), OCapacity, OAlign, OPolicy>*);
+    static std::false_type s_erased(...);
+
+    template <typename T>
+    static constexpr bool proper = !std::is_convertible_v<T*, inplace_func*> &&
+            !decltype(s_erased(std::declval<T*>()))::value &&
+            std::is_invocable_r_v<Ret, const T&, Args&&...>;
+public:
+    using base_type::base_type;
+
+    template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    inplace_func(T&& t) noexcept(std::is_nothrow_constructible_v<std::decay_t<T>, T&&>)
+    {
+        uf_details::check_inplace<std::decay_t<T>, Capacity, Align>();
+        base_type::template construct<signature_type, std::decay_t<T>>(this, std::forward<T>(t));
+    }
+
+    template <typename T, typename... DTArgs, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    inplace_func(std::in_place_type_t<T>, DTArgs&&... args) noexcept(std::is_nothrow_constructible_v<T, DTArgs&&...>)
+    {
+        uf_details::check_inplace<T, Capacity, Align>();
+        base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
+    }
+
+    template <std::size_t OCapacity, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OCapacity, OAlign>, int> = 0>
+    inplace_func(inplace_func<Ret(Args...) const, OCapacity, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    Ret operator()(Args&& ...args) const
+    {
+        return base_type::call(std::forward<Args>(args)...);
+    }
+};
+
+}
@@ -0,0 +1,272 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace vv6
+{
+
+//where a wrapper put its callable
+enum class construct_path
+{
+    inline_storage,
+    external,
+    allocator
+};
+
+//the hooks the owning wrappers call, select others with the instrumentation member of the policy.
+//this one does nothing and costs nothing
+struct no_instrumentation
+{
+    template <typename Sig>
+    static void s_construct(construct_path, std::size_t) noexcept
+    {
+
+    }
+
+    template <typename Sig>
+    static void s_move() noexcept
+    {
+
+    }
+
+    template <typename Sig>
+    static void s_move_assign() noexcept
+    {
+
+    }
+
+    template <typename Sig>
+    static void s_call() noexcept
+    {
+
+    }
+};
+
+//capture sizes up to 8 bytes, up to 16, and so on, the last bucket takes everything above 1024
+inline constexpr std::size_t size_buckets = 9;
+
+struct func_stats
+{
+    std::uint64_t inline_constructs;
+    std::uint64_t external_constructs;
+    std::uint64_t allocator_constructs;
+    std::uint64_t moves;
+    std::uint64_t move_assigns;
+    std::uint64_t calls;
+    std::array<std::uint64_t, size_buckets> sizes;
+};
+
+namespace details
+{
+
+//every thread counts into a block of its own, so that a call costs no locked instruction.
+//the blocks are summed up when asked, those of threads which are gone are folded into s_retired
+template <typename Sig>
+class func_counters
+{
+public:
+    static constexpr std::size_t s_constructs = 0;
+    static constexpr std::size_t s_moves = 3;
+    static constexpr std::size_t s_move_assigns = 4;
+    static constexpr std::size_t s_calls = 5;
+    static constexpr std::size_t s_sizes = 6;
+    static constexpr std::size_t s_count = s_sizes + size_buckets;
+
+private:
+    struct block
+    {
+        //only written by the owning thread
+        std::atomic<std::uint64_t> m_values[s_count] = {};
+        block* m_next = nullptr;
+        block* m_prev = nullptr;
+
+        block()
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            m_next = s_blocks;
+            if(m_next)
+            {
+                m_next->m_prev = this;
+            }
+            s_blocks = this;
+        }
+
+        ~block()
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            for(std::size_t i = 0; i < s_count; ++i)
+            {
+                s_retired[i].fetch_add(m_values[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            (m_prev ? m_prev->m_next : s_blocks) = m_next;
+            if(m_next)
+            {
+                m_next->m_prev = m_prev;
+            }
+            s_local_state() = {nullptr, true};
+        }
+    };
+
+    struct local
+    {
+        block* m_block;
+        bool m_gone;
+    };
+
+    static inline std::mutex s_mutex;
+    static inline block* s_blocks = nullptr;
+    //threads which are gone, and those which could not get a block
+    static inline std::atomic<std::uint64_t> s_retired[s_count] = {};
+
+    static local& s_local_state() noexcept
+    {
+        static thread_local local state{nullptr, false};
+        return state;
+    }
+
+    static block* s_local() noexcept
+    {
+        auto& state = s_local_state();
+        if(state.m_block || state.m_gone)
+        {
+            return state.m_block;
+        }
+        try
+        {
+            static thread_local block b;
+            state.m_block = &b;
+        }
+        catch(...)
+        {
+
+        }
+        return state.m_block;
+    }
+
+public:
+    static void s_add(std::size_t index) noexcept
+    {
+        if(auto b = s_local())
+        {
+            auto& value = b->m_values[index];
+            value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        else
+        {
+            s_retired[index].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void s_read(std::uint64_t (&values)[s_count]) noexcept
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        for(std::size_t i = 0; i < s_count; ++i)
+        {
+            values[i] = s_retired[i].load(std::memory_order_relaxed);
+        }
+        for(auto b = s_blocks; b; b = b->m_next)
+        {
+            for(std::size_t i = 0; i < s_count; ++i)
+            {
+                values[i] += b->m_values[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //counts which race with the reset may survive it
+    static void s_reset() noexcept
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        for(std::size_t i = 0; i < s_count; ++i)
+        {
+            s_retired[i].store(0, std::memory_order_relaxed);
+        }
+        for(auto b = s_blocks; b; b = b->m_next)
+        {
+            for(auto& value : b->m_values)
+            {
+                value.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+inline std::size_t size_bucket(std::size_t size) noexcept
+{
+    std::size_t i = 0;
+    for(std::size_t limit = 8; i + 1 < size_buckets && size > limit; limit *= 2)
+    {
+        ++i;
+    }
+    return i;
+}
+
+}
+
+//counts per signature, the one of the wrapper without const and noexcept.
+//every hook increments a counter of the calling thread, calls included.
+//Sizes also records the size of each constructed callable
+template <bool Sizes = false>
+struct counting_instrumentation
+{
+    template <typename Sig>
+    static void s_construct(construct_path path, std::size_t size) noexcept
+    {
+        using counters = details::func_counters<Sig>;
+        counters::s_add(counters::s_constructs + static_cast<std::size_t>(path));
+        if constexpr(Sizes)
+        {
+            counters::s_add(counters::s_sizes + details::size_bucket(size));
+        }
+    }
+
+    template <typename Sig>
+    static void s_move() noexcept
+    {
+        details::func_counters<Sig>::s_add(details::func_counters<Sig>::s_moves);
+    }
+
+    template <typename Sig>
+    static void s_move_assign() noexcept
+    {
+        details::func_counters<Sig>::s_add(details::func_counters<Sig>::s_move_assigns);
+    }
+
+    template <typename Sig>
+    static void s_call() noexcept
+    {
+        details::func_counters<Sig>::s_add(details::func_counters<Sig>::s_calls);
+    }
+};
+
+//what the counting instrumentation saw for a signature so far, approximate while it is in use
+template <typename Sig>
+func_stats instrumentation_stats() noexcept
+{
+    using counters = details::func_counters<Sig>;
+    std::uint64_t values[counters::s_count];
+    counters::s_read(values);
+    func_stats r{values[counters::s_constructs],
+                 values[counters::s_constructs + 1],
+                 values[counters::s_constructs + 2],
+                 values[counters::s_moves],
+                 values[counters::s_move_assigns],
+                 values[counters::s_calls],
+                 {}};
+    for(std::size_t i = 0; i < size_buckets; ++i)
+    {
+        r.sizes[i] = values[counters::s_sizes + i];
+    }
+    return r;
+}
+
+template <typename Sig>
+void reset_instrumentation_stats() noexcept
+{
+    details::func_counters<Sig>::s_reset();
+}
+
+}
@@ -0,0 +1,277 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include "func_view.hpp"
+#include "shared_func.hpp"
+
+namespace vv6
+{
+
+//reference counting policies of intrusive_func
+struct atomic_count
+{
+    static void increment(std::atomic<std::size_t>& count) noexcept
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static bool decrement(std::atomic<std::size_t>& count) noexcept
+    {
+        return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+};
+
+//plain loads and stores, no lock prefixed instructions
+struct local_count
+{
+    static void increment(std::atomic<std::size_t>& count) noexcept
+    {
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    static bool decrement(std::atomic<std::size_t>& count) noexcept
+    {
+        auto n = count.load(std::memory_order_relaxed) - 1;
+        count.store(n, std::memory_order_relaxed);
+        return n == 0;
+    }
+};
+
+namespace details
+{
+
+struct intrusive_header
+{
+    std::atomic<std::size_t> m_count;
+    void (*m_destroy)(intrusive_header*) noexcept;
+};
+
+template <typename T>
+struct intrusive_block : intrusive_header
+{
+    T m_value;
+
+    template <typename... TArgs>
+    intrusive_block(TArgs&& ...args) :
+        intrusive_header{{1}, s_destroy}, m_value(std::forward<TArgs>(args)...)
+    {
+
+    }
+
+    static void s_destroy(intrusive_header* header) noexcept
+    {
+        delete static_cast<intrusive_block*>(header);
+    }
+
+    template <typename... A>
+    decltype(auto) operator()(A&& ...args)
+    {
+        return m_value(std::forward<A>(args)...);
+    }
+
+    template <typename... A>
+    decltype(auto) operator()(A&& ...args) const
+    {
+        return m_value(std::forward<A>(args)...);
+    }
+};
+
+}
+
+template <typename Sig, typename Count = atomic_count>
+class intrusive_func;
+
+template <typename Ret, typename... Args, typename Count>
+class intrusive_func<Ret(Args...), Count>
+{
+    template <typename, typename>
+    friend class intrusive_func;
+
+    using invoker_type = Ret(*)(details::functor, details::argument_t<Args>...);
+
+    details::intrusive_header* m_block;
+    invoker_type m_invoker;
+
+    template <bool Const, typename T, typename... TArgs>
+    void construct(TArgs&& ...args)
+    {
+        auto p = new details::intrusive_block<T>(std::forward<TArgs>(args)...);
+        m_block = p;
+        m_invoker = &details::invoker<Ret(Args...), details::intrusive_block<T>, Const>::s_invoke;
+    }
+
+    void release() noexcept
+    {
+        if(m_block && Count::decrement(m_block->m_count))
+        {
+            m_block->m_destroy(m_block);
+        }
+    }
+
+    details::functor functor() const noexcept
+    {
+        details::functor f;
+        f.obj = m_block;
+        return f;
+    }
+
+public:
+    constexpr intrusive_func() noexcept :
+        m_block(), m_invoker()
+    {
+
+    }
+
+    template <typename T, typename... TArgs,
+              std::enable_if_t<std::is_invocable_r_v<Ret, const T&, Args&&...>, int> = 0>
+    intrusive_func(std::in_place_type_t<T>, TArgs&& ...args)
+    {
+        construct<true, T>(std::forward<TArgs>(args)...);
+    }
+
+    template <typename T, typename... TArgs,
+              std::enable_if_t<std::is_invocable_r_v<Ret, T&, Args&&...>, int> = 0>
+    intrusive_func(use_non_const_type, std::in_place_type_t<T>, TArgs&& ...args)
+    {
+        construct<false, T>(std::forward<TArgs>(args)...);
+    }
+
+    //the counter is shared by both policies, so only an exclusive owner
+    //can move the block across them
+    template <typename OCount, std::enable_if_t<!std::is_same_v<OCount, Count>, int> = 0>
+    explicit intrusive_func(intrusive_func<Ret(Args...), OCount>&& other) :
+        m_block(other.m_block), m_invoker(other.m_invoker)
+    {
+        if(other.use_count() > 1)
+        {
+            throw std::invalid_argument("vv6::intrusive_func: the block is still shared");
+        }
+        other.m_block = nullptr;
+        other.m_invoker = nullptr;
+    }
+
+    intrusive_func(const intrusive_func& other) noexcept :
+        m_block(other.m_block), m_invoker(other.m_invoker)
+    {
+        if(m_block)
+        {
+            Count::increment(m_block->m_count);
+        }
+    }
+
+    intrusive_func(intrusive_func&& other) noexcept :
+        m_block(other.m_block), m_invoker(other.m_invoker)
+    {
+        other.m_block = nullptr;
+        other.m_invoker = nullptr;
+    }
+
+    intrusive_func& operator=(const intrusive_func& other) noexcept
+    {
+        intrusive_func(other).swap(*this);
+        return *this;
+    }
+
+    intrusive_func& operator=(intrusive_func&& other) noexcept
+    {
+        intrusive_func(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~intrusive_func()
+    {
+        release();
+    }
+
+    void swap(intrusive_func& other) noexcept
+    {
+        std::swap(m_block, other.m_block);
+        std::swap(m_invoker, other.m_invoker);
+    }
+
+    Ret operator()(Args&& ...args) const
+    {
+        return m_invoker(functor(), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_invoker != nullptr;
+    }
+
+    std::size_t use_count() const noexcept
+    {
+        return m_block ? m_block->m_count.load(std::memory_order_relaxed) : 0;
+    }
+
+    func_view<Ret(Args...)> view() const noexcept
+    {
+        return details::func_view_access::make<Ret(Args...)>(functor(), m_invoker);
+    }
+};
+
+template <typename Sig, typename Count = atomic_count, typename T>
+intrusive_func<Sig, Count> make_intrusive_func(T&& t)
+{
+    return intrusive_func<Sig, Count>(std::in_place_type<std::decay_t<T>>, std::forward<T>(t));
+}
+
+template <typename Sig, typename Count = atomic_count, typename T>
+intrusive_func<Sig, Count> make_intrusive_func(use_non_const_type, T&& t)
+{
+    return intrusive_func<Sig, Count>(use_non_const, std::in_place_type<std::decay_t<T>>, std::forward<T>(t));
+}
+
+namespace details
+{
+
+template <typename Count, typename T>
+auto make_deduced_intrusive_func(T&& t)
+{
+    using DT = std::decay_t<T>;
+
+    using M = decltype(&DT::operator());
+
+    using Sig = typename details::signature_from_memfn<M>::type;
+
+    if constexpr(details::signature_from_memfn<M>::is_const)
+    {
+        return intrusive_func<Sig, Count>(std::in_place_type<DT>, std::forward<T>(t));
+    }
+    else
+    {
+        return intrusive_func<Sig, Count>(use_non_const, std::in_place_type<DT>, std::forward<T>(t));
+    }
+}
+
+}
+
+template <typename T, std::enable_if_t<details::has_unique_interface<std::decay_t<T>>::value, int> = 0>
+auto make_intrusive_func(T&& t)
+{
+    return details::make_deduced_intrusive_func<atomic_count>(std::forward<T>(t));
+}
+
+template <typename Sig>
+using local_shared_func = intrusive_func<Sig, local_count>;
+
+template <typename Sig, typename T>
+local_shared_func<Sig> make_local_shared_func(T&& t)
+{
+    return make_intrusive_func<Sig, local_count>(std::forward<T>(t));
+}
+
+template <typename Sig, typename T>
+local_shared_func<Sig> make_local_shared_func(use_non_const_type, T&& t)
+{
+    return make_intrusive_func<Sig, local_count>(use_non_const, std::forward<T>(t));
+}
+
+template <typename T, std::enable_if_t<details::has_unique_interface<std::decay_t<T>>::value, int> = 0>
+auto make_local_shared_func(T&& t)
+{
+    return details::make_deduced_intrusive_func<local_count>(std::forward<T>(t));
+}
+
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "func_view.hpp"
+
+namespace vv6
+{
+
+template <typename... Stages>
+class pipeline;
+
+template <typename... Fs>
+auto compose(Fs&&... fs);
+
+namespace details
+{
+
+//what the next stage is called with, nothing after a stage which returns void
+template <typename R>
+struct stage_output
+{
+    using type = std::tuple<R>;
+};
+
+template <>
+struct stage_output<void>
+{
+    using type = std::tuple<>;
+};
+
+template <typename R>
+using stage_output_t = typename stage_output<R>::type;
+
+//the result of the last stage, absent if a stage cannot take what the one before returned
+template <typename Stages, typename Args, typename = void>
+struct chain_result {};
+
+template <typename S, typename... Args>
+struct chain_result<std::tuple<S>, std::tuple<Args...>, std::void_t<std::invoke_result_t<S, Args...>>>
+{
+    using type = std::invoke_result_t<S, Args...>;
+    static constexpr bool nothrow = std::is_nothrow_invocable_v<S, Args...>;
+};
+
+template <typename S, typename Next, typename... Rest, typename... Args>
+struct chain_result<std::tuple<S, Next, Rest...>, std::tuple<Args...>, std::void_t<std::invoke_result_t<S, Args...>>> :
+        chain_result<std::tuple<Next, Rest...>, stage_output_t<std::invoke_result_t<S, Args...>>>
+{
+    static constexpr bool nothrow = std::is_nothrow_invocable_v<S, Args...> &&
+            chain_result<std::tuple<Next, Rest...>, stage_output_t<std::invoke_result_t<S, Args...>>>::nothrow;
+};
+
+//the result of a stage goes straight into the next one, without a copy in between
+template <std::size_t I, typename Tuple, typename... Args>
+decltype(auto) run_stages(Tuple& stages, Args&&... args)
+{
+    auto& stage = std::get<I>(stages);
+    if constexpr(I + 1 == std::tuple_size_v<std::remove_const_t<Tuple>>)
+    {
+        return std::invoke(stage, std::forward<Args>(args)...);
+    }
+    else if constexpr(std::is_void_v<std::invoke_result_t<decltype(stage), Args&&...>>)
+    {
+        std::invoke(stage, std::forward<Args>(args)...);
+        return run_stages<I + 1>(stages);
+    }
+    else
+    {
+        return run_stages<I + 1>(stages, std::invoke(stage, std::forward<Args>(args)...));
+    }
+}
+
+template <typename T>
+struct is_pipeline : std::false_type {};
+
+template <typename... Stages>
+struct is_pipeline<pipeline<Stages...>> : std::true_type {};
+
+struct pipeline_access
+{
+    //the stages of a pipeline, or the single stage anything else is
+    template <typename F>
+    static auto stages(F&& f)
+    {
+        if constexpr(is_pipeline<std::decay_t<F>>::value)
+        {
+            return std::forward<F>(f).m_stages;
+        }
+        else
+        {
+            return std::tuple<std::decay_t<F>>(std::forward<F>(f));
+        }
+    }
+
+    template <typename... Stages>
+    static pipeline<Stages...> make(std::tuple<Stages...>&& stages)
+    {
+        return pipeline<Stages...>(std::move(stages));
+    }
+};
+
+//a func_view per stage, each called with what the one before returns
+template <typename Args, typename... Fs>
+struct view_stages
+{
+    using type = std::tuple<>;
+};
+
+template <typename... Args, typename F, typename... Fs>
+struct view_stages<std::tuple<Args...>, F, Fs...>
+{
+    using result = std::invoke_result_t<const F&, Args&&...>;
+    using type = decltype(std::tuple_cat(std::declval<std::tuple<func_view<result(Args...)>>>(),
+                                         std::declval<typename view_stages<stage_output_t<result>, Fs...>::type>()));
+};
+
+}
+
+//stages which run one after the other, each gets what the previous one returned, nothing if that was void.
+//they are kept side by side in one object, a wrapper built from it reaches all of them through its one invoker
+//and the stages are called directly from there
+template <typename... Stages>
+class pipeline
+{
+    static_assert(sizeof...(Stages) > 0, "a pipeline needs a stage");
+
+    friend struct details::pipeline_access;
+
+    std::tuple<Stages...> m_stages;
+
+    explicit pipeline(std::tuple<Stages...>&& stages) :
+        m_stages(std::move(stages))
+    {
+
+    }
+
+public:
+    template <typename... Args, typename Chain = details::chain_result<std::tuple<Stages&...>, std::tuple<Args&&...>>>
+    typename Chain::type operator()(Args&&... args) noexcept(Chain::nothrow)
+    {
+        return details::run_stages<0>(m_stages, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args,
+              typename Chain = details::chain_result<std::tuple<const Stages&...>, std::tuple<Args&&...>>>
+    typename Chain::type operator()(Args&&... args) const noexcept(Chain::nothrow)
+    {
+        return details::run_stages<0>(m_stages, std::forward<Args>(args)...);
+    }
+
+    //appends stages, the result is flat again
+    template <typename... Fs>
+    auto then(Fs&&... fs) const &
+    {
+        return compose(*this, std::forward<Fs>(fs)...);
+    }
+
+    template <typename... Fs>
+    auto then(Fs&&... fs) &&
+    {
+        return compose(std::move(*this), std::forward<Fs>(fs)...);
+    }
+
+    static constexpr std::size_t size() noexcept
+    {
+        return sizeof...(Stages);
+    }
+};
+
+//pipelines among the arguments are flattened, so composing in steps gives the same type as composing at once.
+//wrappers are stages like any other, each of them still costs its own indirect call
+template <typename... Fs>
+auto compose(Fs&&... fs)
+{
+    return details::pipeline_access::make(std::tuple_cat(details::pipeline_access::stages(std::forward<Fs>(fs))...));
+}
+
+//the non-owning flavour, a func_view per stage which must outlive the pipeline, Args are those of the first stage.
+//the result takes two pointers per stage and is copied like a plain struct
+template <typename... Args, typename... Fs>
+auto compose_view(const Fs&... fs)
+{
+    typename details::view_stages<std::tuple<Args...>, Fs...>::type stages(fs...);
+    return details::pipeline_access::make(std::move(stages));
+}
+
+//a view of a temporary would dangle at the end of the statement, an rvalue among the stages picks this one
+template <typename... Args, typename... Fs, std::enable_if_t<!(std::is_lvalue_reference_v<Fs> && ...), int> = 0>
+auto compose_view(Fs&&... fs) = delete;
+
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace vv6
+{
+
+namespace details
+{
+
+//readers announce themselves in a record of their own thread, so they do not share a cache line.
+//a reader notes the global epoch when it enters. a writer which has replaced a version bumps the epoch
+//and tags the old version with the epoch it replaced it in. the old version may be freed once every reader
+//is idle or has entered after that, so readers which keep overlapping do not hold back what they cannot see
+class rcu_readers
+{
+    static constexpr std::size_t s_cache_line = 64;
+
+public:
+    struct alignas(s_cache_line) record
+    {
+        //the epoch the outermost section was entered in, 0 while idle
+        std::atomic<std::uint64_t> m_epoch{0};
+        std::atomic<bool> m_used{true};
+        std::size_t m_nest = 0;
+        record* m_next = nullptr;
+    };
+
+private:
+    static inline std::atomic<std::uint64_t> s_epoch{1};
+
+    //records are reused by later threads and never freed
+    static inline std::atomic<record*> s_head{nullptr};
+
+    static record* s_acquire()
+    {
+        for(auto r = s_head.load(std::memory_order_acquire); r; r = r->m_next)
+        {
+            if(!r->m_used.load(std::memory_order_relaxed) && !r->m_used.exchange(true, std::memory_order_acquire))
+            {
+                return r;
+            }
+        }
+        auto r = new record;
+        r->m_next = s_head.load(std::memory_order_relaxed);
+        while(!s_head.compare_exchange_weak(r->m_next, r, std::memory_order_release, std::memory_order_relaxed))
+        {
+
+        }
+        return r;
+    }
+
+    struct holder
+    {
+        record* m_record;
+
+        ~holder()
+        {
+            m_record->m_used.store(false, std::memory_order_release);
+        }
+    };
+
+    static record& s_local()
+    {
+        static thread_local holder local{s_acquire()};
+        return *local.m_record;
+    }
+
+public:
+    //nests, also across different structures. the current version must be loaded seq_cst afterwards
+    static record& s_enter()
+    {
+        auto& r = s_local();
+        if(r.m_nest++ == 0)
+        {
+            r.m_epoch.store(s_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+        return r;
+    }
+
+    //takes what s_enter returned
+    static void s_leave(record& r) noexcept
+    {
+        if(--r.m_nest == 0)
+        {
+            r.m_epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    //the new version must have been published with a seq_cst store before, returns the tag of the old one.
+    //a reader which enters in a later epoch can only find the new version
+    static std::uint64_t s_retire() noexcept
+    {
+        return s_epoch.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    //what was retired with an earlier tag is not seen by any reader anymore
+    static std::uint64_t s_oldest() noexcept
+    {
+        auto oldest = UINT64_MAX;
+        for(auto r = s_head.load(std::memory_order_acquire); r; r = r->m_next)
+        {
+            auto epoch = r->m_epoch.load(std::memory_order_seq_cst);
+            if(epoch)
+            {
+                oldest = std::min(oldest, epoch);
+            }
+        }
+        return oldest;
+    }
+};
+
+//what a writer has replaced, in the order it was retired, so the tags only grow
+template <typename T>
+class rcu_retired
+{
+    std::vector<std::pair<std::uint64_t, std::unique_ptr<T>>> m_items;
+
+public:
+    //makes room so that retiring cannot fail
+    void reserve(std::size_t n)
+    {
+        if(m_items.capacity() < m_items.size() + n)
+        {
+            m_items.reserve(std::max(2 * m_items.capacity(), m_items.size() + n));
+        }
+    }
+
+    void retire(std::uint64_t tag, std::unique_ptr<T> p) noexcept
+    {
+        m_items.emplace_back(tag, std::move(p));
+    }
+
+    void reclaim(std::uint64_t oldest) noexcept
+    {
+        auto it = m_items.begin();
+        while(it != m_items.end() && it->first < oldest)
+        {
+            ++it;
+        }
+        m_items.erase(m_items.begin(), it);
+    }
+};
+
+}
+
+}
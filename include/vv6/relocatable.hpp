@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace vv6
+{
+
+//whether a T can be moved to another address by copying its bytes, the source is then not destroyed.
+//trivially copyable types are, others opt in with a specialization:
+//template <> struct vv6::is_trivially_relocatable<my_type> : std::true_type {};
+//a lambda is covered when its captures are trivially copyable. the trait cannot look at the captures
+//of any other lambda, so it has to opt in through the type of a named function which returns it:
+//inline auto make_handler() { return [p = std::make_unique<int>(1)](int x) { return x + *p; }; }
+//template <> struct vv6::is_trivially_relocatable<decltype(make_handler())> : std::true_type {};
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template <typename T>
+struct is_trivially_relocatable<const T> : is_trivially_relocatable<T> {};
+
+template <typename T, typename U>
+struct is_trivially_relocatable<std::unique_ptr<T, std::default_delete<U>>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+template <typename A, typename B>
+struct is_trivially_relocatable<std::pair<A, B>> :
+        std::bool_constant<is_trivially_relocatable_v<A> && is_trivially_relocatable_v<B>> {};
+
+template <typename... Ts>
+struct is_trivially_relocatable<std::tuple<Ts...>> : std::bool_constant<(is_trivially_relocatable_v<Ts> && ...)> {};
+
+template <typename T, std::size_t N>
+struct is_trivially_relocatable<std::array<T, N>> : is_trivially_relocatable<T> {};
+
+//only where the containers are known not to point into themselves,
+//libstdc++ keeps short strings in place and points at them
+#if defined(__GLIBCXX__) || defined(_LIBCPP_VERSION)
+template <typename T>
+struct is_trivially_relocatable<std::vector<T, std::allocator<T>>> : std::true_type {};
+#endif
+
+#if defined(_LIBCPP_VERSION)
+template <typename C, typename Traits>
+struct is_trivially_relocatable<std::basic_string<C, Traits, std::allocator<C>>> : std::true_type {};
+#endif
+
+}
@@ -0,0 +1,373 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "rcu_readers.hpp"
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+template <typename Sig>
+class signal;
+
+namespace details
+{
+
+class signal_state_base
+{
+public:
+    virtual ~signal_state_base() = default;
+    virtual bool disconnect(std::uint64_t id) = 0;
+    virtual bool connected(std::uint64_t id) = 0;
+};
+
+//slots are shared between the snapshots, a snapshot is never modified once published.
+//what was replaced is kept in the retired lists until no emission can see it, writers free it
+//when they publish the next time, emissions never do
+template <typename Func>
+class signal_state final : public signal_state_base
+{
+public:
+    struct slot
+    {
+        std::uint64_t m_id;
+        std::atomic<bool> m_connected;
+        Func m_func;
+
+        template <typename T>
+        slot(std::uint64_t id, T&& t) :
+            m_id(id), m_connected(true), m_func(std::forward<T>(t))
+        {
+
+        }
+    };
+
+    using snapshot = std::vector<slot*>;
+
+private:
+    std::atomic<const snapshot*> m_snapshot;
+
+    std::mutex m_mutex;
+    std::uint64_t m_next_id;
+    rcu_retired<const snapshot> m_retired;
+    rcu_retired<slot> m_retired_slots;
+
+    //under the mutex, makes room so that publishing cannot fail
+    void reserve_retired(std::size_t slots)
+    {
+        m_retired.reserve(1);
+        m_retired_slots.reserve(slots);
+    }
+
+    //under the mutex, returns the tag the slots removed with it are retired with
+    std::uint64_t publish(std::unique_ptr<snapshot> next) noexcept
+    {
+        std::unique_ptr<const snapshot> prev(m_snapshot.load(std::memory_order_relaxed));
+        m_snapshot.store(next.release(), std::memory_order_seq_cst);
+        auto tag = rcu_readers::s_retire();
+        if(prev)
+        {
+            m_retired.retire(tag, std::move(prev));
+        }
+        return tag;
+    }
+
+    //under the mutex
+    void reclaim() noexcept
+    {
+        auto oldest = rcu_readers::s_oldest();
+        m_retired.reclaim(oldest);
+        m_retired_slots.reclaim(oldest);
+    }
+
+public:
+    signal_state() :
+        m_snapshot(nullptr), m_next_id(0)
+    {
+
+    }
+
+    ~signal_state()
+    {
+        if(auto cur = m_snapshot.load(std::memory_order_relaxed))
+        {
+            for(auto s : *cur)
+            {
+                delete s;
+            }
+            delete cur;
+        }
+    }
+
+    template <typename T>
+    std::uint64_t connect(T&& t)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto s = std::make_unique<slot>(m_next_id, std::forward<T>(t));
+        auto next = std::make_unique<snapshot>();
+        if(auto cur = m_snapshot.load(std::memory_order_relaxed))
+        {
+            next->reserve(cur->size() + 1);
+            *next = *cur;
+        }
+        next->push_back(s.get());
+        reserve_retired(0);
+        publish(std::move(next));
+        reclaim();
+        s.release();
+        return m_next_id++;
+    }
+
+    bool disconnect(std::uint64_t id) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto cur = m_snapshot.load(std::memory_order_relaxed);
+        if(!cur)
+        {
+            return false;
+        }
+        for(auto s : *cur)
+        {
+            if(s->m_id == id)
+            {
+                auto next = std::make_unique<snapshot>();
+                next->reserve(cur->size() - 1);
+                for(auto o : *cur)
+                {
+                    if(o != s)
+                    {
+                        next->push_back(o);
+                    }
+                }
+                reserve_retired(1);
+                s->m_connected.store(false, std::memory_order_relaxed);
+                m_retired_slots.retire(publish(std::move(next)), std::unique_ptr<slot>(s));
+                reclaim();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool connected(std::uint64_t id) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(auto cur = m_snapshot.load(std::memory_order_relaxed))
+        {
+            for(auto s : *cur)
+            {
+                if(s->m_id == id)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void disconnect_all()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto cur = m_snapshot.load(std::memory_order_relaxed);
+        if(!cur)
+        {
+            return;
+        }
+        reserve_retired(cur->size());
+        for(auto s : *cur)
+        {
+            s->m_connected.store(false, std::memory_order_relaxed);
+        }
+        auto tag = publish(nullptr);
+        for(auto s : *cur)
+        {
+            m_retired_slots.retire(tag, std::unique_ptr<slot>(s));
+        }
+        reclaim();
+    }
+
+    std::size_t size() const noexcept
+    {
+        auto cur = m_snapshot.load(std::memory_order_acquire);
+        return cur ? cur->size() : 0;
+    }
+
+    //keeps the snapshot alive while the slots are called
+    struct read_guard
+    {
+        signal_state* m_state;
+        rcu_readers::record& m_record;
+
+        explicit read_guard(signal_state* state) :
+            m_state(state), m_record(rcu_readers::s_enter())
+        {
+
+        }
+
+        ~read_guard()
+        {
+            rcu_readers::s_leave(m_record);
+        }
+
+        const snapshot* get() const noexcept
+        {
+            return m_state->m_snapshot.load(std::memory_order_seq_cst);
+        }
+    };
+};
+
+}
+
+//handle to a connected slot, it does not keep the signal alive
+class connection
+{
+    template <typename Sig>
+    friend class signal;
+
+    std::weak_ptr<details::signal_state_base> m_state;
+    std::uint64_t m_id = 0;
+
+    connection(std::weak_ptr<details::signal_state_base> state, std::uint64_t id) noexcept :
+        m_state(std::move(state)), m_id(id)
+    {
+
+    }
+
+public:
+    connection() noexcept = default;
+
+    //returns false if the slot was already disconnected or the signal is gone
+    bool disconnect()
+    {
+        auto state = m_state.lock();
+        m_state.reset();
+        return state && state->disconnect(m_id);
+    }
+
+    bool connected() const
+    {
+        auto state = m_state.lock();
+        return state && state->connected(m_id);
+    }
+};
+
+//disconnects on destruction
+class scoped_connection : public connection
+{
+public:
+    scoped_connection() noexcept = default;
+
+    scoped_connection(connection c) noexcept :
+        connection(std::move(c))
+    {
+
+    }
+
+    scoped_connection(scoped_connection&&) noexcept = default;
+    scoped_connection(const scoped_connection&) = delete;
+
+    scoped_connection& operator=(scoped_connection&& other) noexcept
+    {
+        if(this != &other)
+        {
+            disconnect();
+            connection::operator=(std::move(other));
+        }
+        return *this;
+    }
+
+    scoped_connection& operator=(const scoped_connection&) = delete;
+
+    ~scoped_connection()
+    {
+        disconnect();
+    }
+
+    connection release() noexcept
+    {
+        return std::move(*this);
+    }
+};
+
+//emitting takes no lock and touches no per slot counter, it walks an immutable snapshot of the slots.
+//connecting and disconnecting copy the slot array under a mutex and publish the copy.
+//slots connected during an emission are not called by it, disconnected ones are skipped
+template <typename... Args>
+class signal<void(Args...)>
+{
+    static_assert((!std::is_rvalue_reference_v<Args> && ...),
+                  "signal cannot hand the same rvalue to several slots");
+
+public:
+    using slot_type = unique_func<void(Args...)>;
+
+private:
+    using state_type = details::signal_state<slot_type>;
+
+    std::shared_ptr<state_type> m_state;
+
+public:
+    signal() :
+        m_state(std::make_shared<state_type>())
+    {
+
+    }
+
+    signal(const signal&) = delete;
+    signal& operator=(const signal&) = delete;
+
+    //there must not be any emission running when the signal is destroyed
+    ~signal() = default;
+
+    template <typename T, std::enable_if_t<std::is_constructible_v<slot_type, T&&>, int> = 0>
+    connection connect(T&& t)
+    {
+        return connection(m_state, m_state->connect(std::forward<T>(t)));
+    }
+
+    void disconnect_all()
+    {
+        m_state->disconnect_all();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_state->size();
+    }
+
+    bool empty() const noexcept
+    {
+        return size() == 0;
+    }
+
+    //every slot gets the same arguments, values are copied for each call
+    void emit(Args... args) const
+    {
+        typename state_type::read_guard guard(m_state.get());
+        auto snap = guard.get();
+        if(!snap)
+        {
+            return;
+        }
+        for(auto s : *snap)
+        {
+            if(s->m_connected.load(std::memory_order_relaxed))
+            {
+                s->m_func(static_cast<Args>(args)...);
+            }
+        }
+    }
+
+    void operator()(Args... args) const
+    {
+        emit(static_cast<Args>(args)...);
+    }
+};
+
+}
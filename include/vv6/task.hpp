@@ -0,0 +1,437 @@
+#pragma once
+
+#ifndef __cpp_impl_coroutine
+#error "vv6/task.hpp requires C++20 coroutines"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+template <typename T = void>
+class task;
+
+//a unique_func<void()> compatible callable which resumes a coroutine, it fits into the inline buffer.
+//it does not own the coroutine, one which is never resumed is leaked
+class resumer
+{
+    std::coroutine_handle<> m_handle;
+public:
+    explicit resumer(std::coroutine_handle<> handle) noexcept :
+        m_handle(handle)
+    {
+
+    }
+
+    void operator()() const
+    {
+        m_handle.resume();
+    }
+};
+
+static_assert(uf_details::is_inplace<resumer, uf_details::storage_type>);
+
+namespace details
+{
+
+template <typename T>
+struct task_handler
+{
+    using type = unique_func<void(T)>;
+};
+
+template <>
+struct task_handler<void>
+{
+    using type = unique_func<void()>;
+};
+
+//the continuation is the awaiting coroutine, the handler is what a started task calls when done.
+//both are kept in the frame, nothing else is allocated
+template <typename T>
+class task_promise_base
+{
+public:
+    std::coroutine_handle<> m_continuation;
+    typename task_handler<T>::type m_handler;
+    bool m_detached = false;
+
+    struct final_awaiter
+    {
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+        {
+            auto& p = h.promise();
+            if(p.m_detached)
+            {
+                p.complete();
+                h.destroy();
+                return std::noop_coroutine();
+            }
+            return p.m_continuation ? p.m_continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept
+        {
+
+        }
+    };
+
+    std::suspend_always initial_suspend() noexcept
+    {
+        return {};
+    }
+
+    final_awaiter final_suspend() noexcept
+    {
+        return {};
+    }
+};
+
+template <typename T>
+class task_promise : public task_promise_base<T>
+{
+    std::variant<std::monostate, T, std::exception_ptr> m_result;
+public:
+    task<T> get_return_object() noexcept;
+
+    template <typename U, std::enable_if_t<std::is_convertible_v<U&&, T>, int> = 0>
+    void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>)
+    {
+        m_result.template emplace<1>(std::forward<U>(value));
+    }
+
+    void unhandled_exception() noexcept
+    {
+        m_result.template emplace<2>(std::current_exception());
+    }
+
+    T result()
+    {
+        if(m_result.index() == 2)
+        {
+            std::rethrow_exception(std::get<2>(m_result));
+        }
+        return std::move(std::get<1>(m_result));
+    }
+
+    //an exception escaping a started task terminates, there is nobody to take it
+    void complete() noexcept
+    {
+        if(this->m_handler)
+        {
+            this->m_handler(result());
+        }
+        else
+        {
+            static_cast<void>(result());
+        }
+    }
+};
+
+template <>
+class task_promise<void> : public task_promise_base<void>
+{
+    std::exception_ptr m_exception;
+public:
+    task<void> get_return_object() noexcept;
+
+    void return_void() noexcept
+    {
+
+    }
+
+    void unhandled_exception() noexcept
+    {
+        m_exception = std::current_exception();
+    }
+
+    void result()
+    {
+        if(m_exception)
+        {
+            std::rethrow_exception(m_exception);
+        }
+    }
+
+    void complete() noexcept
+    {
+        result();
+        if(m_handler)
+        {
+            m_handler();
+        }
+    }
+};
+
+template <typename T>
+struct callback_value
+{
+    using handler_type = unique_func<void(T)>;
+
+    std::optional<T> m_value;
+
+    void set(T value)
+    {
+        m_value.emplace(std::move(value));
+    }
+
+    T get()
+    {
+        return std::move(*m_value);
+    }
+};
+
+template <>
+struct callback_value<void>
+{
+    using handler_type = unique_func<void()>;
+
+    void set() noexcept
+    {
+
+    }
+
+    void get() noexcept
+    {
+
+    }
+};
+
+}
+
+//lazy coroutine, it runs once it is awaited or started
+template <typename T>
+class task
+{
+    static_assert(!std::is_reference_v<T>, "task cannot return a reference");
+
+public:
+    using promise_type = details::task_promise<T>;
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+
+    struct awaiter
+    {
+        std::coroutine_handle<promise_type> m_handle;
+
+        bool await_ready() noexcept
+        {
+            return m_handle.done();
+        }
+
+        //symmetric transfer, the awaiting coroutine is resumed the same way once this one is done
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+        {
+            m_handle.promise().m_continuation = continuation;
+            return m_handle;
+        }
+
+        T await_resume()
+        {
+            return m_handle.promise().result();
+        }
+    };
+
+public:
+    task() noexcept = default;
+
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept :
+        m_handle(handle)
+    {
+
+    }
+
+    task(task&& other) noexcept :
+        m_handle(std::exchange(other.m_handle, nullptr))
+    {
+
+    }
+
+    task& operator=(task&& other) noexcept
+    {
+        if(this != &other)
+        {
+            if(m_handle)
+            {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~task()
+    {
+        if(m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return static_cast<bool>(m_handle);
+    }
+
+    bool done() const noexcept
+    {
+        return m_handle.done();
+    }
+
+    awaiter operator co_await() const & noexcept
+    {
+        return {m_handle};
+    }
+
+    awaiter operator co_await() const && noexcept
+    {
+        return {m_handle};
+    }
+
+    //runs the task detached, the handler gets the result and the frame frees itself.
+    //an exception escaping the task or the handler terminates the program
+    template <typename F, std::enable_if_t<std::is_constructible_v<typename details::task_handler<T>::type, F&&>, int> = 0>
+    void start(F&& handler) &&
+    {
+        auto& p = m_handle.promise();
+        p.m_handler = typename details::task_handler<T>::type(std::forward<F>(handler));
+        std::move(*this).start();
+    }
+
+    void start() &&
+    {
+        auto h = std::exchange(m_handle, nullptr);
+        h.promise().m_detached = true;
+        h.resume();
+    }
+};
+
+namespace details
+{
+
+template <typename T>
+task<T> task_promise<T>::get_return_object() noexcept
+{
+    return task<T>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept
+{
+    return task<void>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+}
+
+//suspends and hands a completion handler to a callback based operation, resumes once it is called.
+//the handler is a unique_func holding a single pointer, it never allocates.
+//it must be called exactly once, possibly before the operation returns. then the coroutine is not
+//resumed from within the handler, it simply does not suspend, so synchronous completions do not nest
+template <typename T, typename Init>
+class callback_awaiter : private details::callback_value<T>
+{
+    using value_type = details::callback_value<T>;
+
+public:
+    using handler_type = typename value_type::handler_type;
+
+private:
+    Init m_init;
+    std::coroutine_handle<> m_handle;
+    //set by the handler and by await_suspend once the operation is started, the second one continues
+    std::atomic<bool> m_done;
+
+    struct completion
+    {
+        callback_awaiter* m_self;
+
+        template <typename... U>
+        void operator()(U&&... value) const
+        {
+            m_self->set(std::forward<U>(value)...);
+            if(m_self->m_done.exchange(true, std::memory_order_acq_rel))
+            {
+                m_self->m_handle.resume();
+            }
+        }
+    };
+
+    static_assert(uf_details::is_inplace<completion, uf_details::storage_type>);
+
+public:
+    template <typename I>
+    explicit callback_awaiter(I&& init) :
+        m_init(std::forward<I>(init)), m_done(false)
+    {
+
+    }
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    //nothing may touch the awaiter once the flag is set, it may be gone already
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        m_handle = h;
+        m_init(handler_type(std::in_place_type<completion>, completion{this}));
+        return !m_done.exchange(true, std::memory_order_acq_rel);
+    }
+
+    T await_resume()
+    {
+        return value_type::get();
+    }
+};
+
+//co_await await_callback<int>([](unique_func<void(int)> done) { start_reading(std::move(done)); });
+template <typename T = void, typename Init>
+callback_awaiter<T, std::decay_t<Init>> await_callback(Init&& init)
+{
+    return callback_awaiter<T, std::decay_t<Init>>(std::forward<Init>(init));
+}
+
+//continues the coroutine in whatever the executor runs, it only needs a post taking a resumer
+template <typename Executor>
+class resume_on
+{
+    Executor& m_executor;
+public:
+    explicit resume_on(Executor& executor) noexcept :
+        m_executor(executor)
+    {
+
+    }
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        m_executor.post(resumer(h));
+    }
+
+    void await_resume() noexcept
+    {
+
+    }
+};
+
+}
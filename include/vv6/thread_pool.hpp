@@ -0,0 +1,434 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+namespace details
+{
+
+//Chase-Lev deque with a fixed capacity, the owner pushes and pops at the bottom, thieves take from the top
+//tasks live in the slots, a slot stays full until whoever took it has moved the task out
+class work_deque
+{
+public:
+    using task_type = unique_func<void()>;
+
+private:
+    static constexpr std::size_t s_cache_line = 64;
+
+    struct slot
+    {
+        std::atomic<bool> m_full{false};
+        task_type m_task;
+    };
+
+    std::unique_ptr<slot[]> m_slots;
+    std::ptrdiff_t m_mask;
+    alignas(s_cache_line) std::atomic<std::ptrdiff_t> m_top;
+    alignas(s_cache_line) std::atomic<std::ptrdiff_t> m_bottom;
+
+    static void s_take(slot& s, task_type& out) noexcept
+    {
+        out = std::move(s.m_task);
+        s.m_full.store(false, std::memory_order_release);
+    }
+
+public:
+    //capacity must be a power of two
+    explicit work_deque(std::size_t capacity) :
+        m_slots(new slot[capacity]), m_mask(static_cast<std::ptrdiff_t>(capacity) - 1), m_top(0), m_bottom(0)
+    {
+
+    }
+
+    bool empty() const noexcept
+    {
+        return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire);
+    }
+
+    //owner only, returns false without touching t if the deque is full
+    template <typename T>
+    bool try_push(T&& t)
+    {
+        auto b = m_bottom.load(std::memory_order_relaxed);
+        if(b - m_top.load(std::memory_order_acquire) > m_mask)
+        {
+            return false;
+        }
+        slot& s = m_slots[b & m_mask];
+        //a thief may still be moving the previous task out
+        while(s.m_full.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        using DT = std::decay_t<T>;
+        if constexpr(std::is_same_v<DT, task_type> ||
+                     !std::is_constructible_v<task_type, std::in_place_type_t<DT>, T&&>)
+        {
+            s.m_task = task_type(std::forward<T>(t));
+        }
+        else
+        {
+            s.m_task.template emplace<DT>(std::forward<T>(t));
+        }
+        s.m_full.store(true, std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    //owner only
+    bool try_pop(task_type& out) noexcept
+    {
+        auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = m_top.load(std::memory_order_relaxed);
+        if(t > b)
+        {
+            m_bottom.store(b + 1, std::memory_order_release);
+            return false;
+        }
+        if(t == b)
+        {
+            //the last one, race the thieves for it
+            bool won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_release);
+            if(!won)
+            {
+                return false;
+            }
+        }
+        s_take(m_slots[b & m_mask], out);
+        return true;
+    }
+
+    bool try_steal(task_type& out) noexcept
+    {
+        auto t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = m_bottom.load(std::memory_order_acquire);
+        if(t >= b || !m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return false;
+        }
+        s_take(m_slots[t & m_mask], out);
+        return true;
+    }
+};
+
+}
+
+//work stealing pool, every worker owns a deque and idle workers steal from the others
+//tasks posted from outside, or which do not fit into a full deque, go to a shared queue
+//an exception escaping a task terminates the program, as it would with std::thread
+class thread_pool
+{
+public:
+    using task_type = unique_func<void()>;
+
+private:
+    struct worker
+    {
+        details::work_deque m_deque;
+        std::thread m_thread;
+
+        explicit worker(std::size_t capacity) :
+            m_deque(capacity)
+        {
+
+        }
+    };
+
+    struct current_worker
+    {
+        thread_pool* m_pool;
+        worker* m_worker;
+        std::size_t m_index;
+    };
+
+    static constexpr std::size_t s_inject_batch = 32;
+
+    std::vector<std::unique_ptr<worker>> m_workers;
+
+    std::mutex m_inject_mutex;
+    std::deque<task_type> m_injected;
+    std::atomic<std::size_t> m_injected_count;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::uint64_t m_epoch;
+    bool m_stop;
+    std::atomic<std::size_t> m_sleepers;
+    std::atomic<bool> m_waking;
+
+    static current_worker& s_current() noexcept
+    {
+        static thread_local current_worker current{};
+        return current;
+    }
+
+    worker* local_worker() const noexcept
+    {
+        auto& c = s_current();
+        return c.m_pool == this ? c.m_worker : nullptr;
+    }
+
+    template <typename T>
+    void inject(T&& t)
+    {
+        std::lock_guard<std::mutex> lock(m_inject_mutex);
+        m_injected.emplace_back(std::forward<T>(t));
+        m_injected_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //takes a batch at once to keep the lock cold, the rest goes to the own deque where it can be stolen
+    bool try_take_injected(worker& w, task_type& out)
+    {
+        if(m_injected_count.load(std::memory_order_relaxed) == 0)
+        {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(m_inject_mutex);
+        if(m_injected.empty())
+        {
+            return false;
+        }
+        out = std::move(m_injected.front());
+        m_injected.pop_front();
+        std::size_t n = std::min<std::size_t>(m_injected.size() / 2, s_inject_batch);
+        for(; n && w.m_deque.try_push(std::move(m_injected.front())); --n)
+        {
+            m_injected.pop_front();
+        }
+        m_injected_count.store(m_injected.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    bool find(std::size_t index, task_type& out)
+    {
+        auto& w = *m_workers[index];
+        if(w.m_deque.try_pop(out) || try_take_injected(w, out))
+        {
+            return true;
+        }
+        for(std::size_t i = 1; i < m_workers.size(); ++i)
+        {
+            if(m_workers[(index + i) % m_workers.size()]->m_deque.try_steal(out))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool work_available() const noexcept
+    {
+        if(m_injected_count.load(std::memory_order_relaxed) != 0)
+        {
+            return true;
+        }
+        for(auto& w : m_workers)
+        {
+            if(!w->m_deque.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void notify()
+    {
+        //pairs with the fence in wait, either the sleeper sees the task or we see the sleeper
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        //one wake up at a time, the woken worker passes it on once it has found work
+        if(m_sleepers.load(std::memory_order_relaxed) == 0 || m_waking.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        {
+            //decided under the lock, where the sleepers are counted and the leaving worker clears the token.
+            //then a set token always belongs to a wake up which a sleeper has yet to take
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(m_sleepers.load(std::memory_order_relaxed) == 0 || m_waking.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            m_waking.store(true, std::memory_order_relaxed);
+            ++m_epoch;
+        }
+        m_cv.notify_one();
+    }
+
+    //returns false once the pool is stopping and there is nothing left to run
+    bool wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto epoch = m_epoch;
+        m_sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool run = true;
+        if(!work_available())
+        {
+            if(m_stop)
+            {
+                run = false;
+            }
+            else
+            {
+                m_cv.wait(lock, [&] { return m_stop || m_epoch != epoch; });
+            }
+        }
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+        m_waking.store(false, std::memory_order_relaxed);
+        return run;
+    }
+
+    void run(std::size_t index) noexcept
+    {
+        s_current() = {this, m_workers[index].get(), index};
+        task_type task;
+        bool woken = false;
+        for(;;)
+        {
+            if(find(index, task))
+            {
+                if(woken)
+                {
+                    woken = false;
+                    notify();
+                }
+                task();
+                task.reset();
+            }
+            else if(!wait())
+            {
+                break;
+            }
+            else
+            {
+                woken = true;
+            }
+        }
+        s_current() = {};
+    }
+
+    void stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for(auto& w : m_workers)
+        {
+            if(w->m_thread.joinable())
+            {
+                w->m_thread.join();
+            }
+        }
+    }
+
+public:
+    explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency(), std::size_t deque_capacity = 256) :
+        m_injected_count(0), m_epoch(0), m_stop(false), m_sleepers(0), m_waking(false)
+    {
+        threads = threads ? threads : 1;
+        std::size_t capacity = 2;
+        while(capacity < deque_capacity)
+        {
+            capacity <<= 1;
+        }
+
+        m_workers.reserve(threads);
+        for(std::size_t i = 0; i < threads; ++i)
+        {
+            m_workers.push_back(std::make_unique<worker>(capacity));
+        }
+        try
+        {
+            for(std::size_t i = 0; i < threads; ++i)
+            {
+                m_workers[i]->m_thread = std::thread([this, i] { run(i); });
+            }
+        }
+        catch(...)
+        {
+            stop();
+            throw;
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    //runs whatever is still queued, then joins the workers
+    ~thread_pool()
+    {
+        stop();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_workers.size();
+    }
+
+    bool running_in_this_thread() const noexcept
+    {
+        return local_worker() != nullptr;
+    }
+
+    //queues the task and wakes an idle worker
+    template <typename T>
+    void post(T&& t)
+    {
+        auto w = local_worker();
+        if(!w || !w->m_deque.try_push(std::forward<T>(t)))
+        {
+            inject(std::forward<T>(t));
+        }
+        notify();
+    }
+
+    //runs the task right away if called from one of the workers, otherwise posts it
+    template <typename T>
+    void dispatch(T&& t)
+    {
+        if(local_worker())
+        {
+            std::forward<T>(t)();
+        }
+        else
+        {
+            post(std::forward<T>(t));
+        }
+    }
+
+    //a continuation of the running task, queued on this worker without waking others
+    template <typename T>
+    void defer(T&& t)
+    {
+        auto w = local_worker();
+        if(w && w->m_deque.try_push(std::forward<T>(t)))
+        {
+            return;
+        }
+        inject(std::forward<T>(t));
+        notify();
+    }
+};
+
+}
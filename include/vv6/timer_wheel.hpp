@@ -0,0 +1,351 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "unique_func.hpp"
+
+namespace vv6
+{
+
+//hierarchical timing wheel in ticks, the unit is up to the caller.
+//four levels of 256 slots cover delays up to 2^32 ticks, longer ones are parked in the last level
+//and placed again when they come down. each slot is an intrusive list of nodes which hold the callable,
+//nodes come from slabs and are reused, so schedule and cancel are O(1) without an allocation.
+//pending callables are destroyed with the wheel, which is not thread safe
+template <std::size_t Size = default_capacity, std::size_t Align = default_alignment,
+          typename Policy = default_policy>
+class timer_wheel
+{
+public:
+    using value_type = basic_unique_func<void(), Size, Align, Policy>;
+
+private:
+    static constexpr unsigned s_bits = 8;
+    static constexpr std::size_t s_slots = std::size_t(1) << s_bits;
+    static constexpr std::size_t s_mask = s_slots - 1;
+    static constexpr std::size_t s_levels = 4;
+    static constexpr std::uint64_t s_max_delay = (std::uint64_t(1) << (s_bits * s_levels)) - 1;
+    static constexpr std::size_t s_slab = 256;
+
+    struct link
+    {
+        link* m_prev;
+        link* m_next;
+    };
+
+    //linked while scheduled, m_prev is null otherwise.
+    //the generation changes whenever the node is freed, so old handles do not match a new timer
+    struct node : link
+    {
+        std::uint64_t m_deadline;
+        std::uint32_t m_generation;
+        std::uint8_t m_level;
+        value_type m_func;
+    };
+
+    std::uint64_t m_now;
+    std::size_t m_size;
+    //timers per level, the ticks before the lowest occupied level comes down are skipped
+    std::size_t m_counts[s_levels];
+    node* m_free;
+    std::vector<std::unique_ptr<node[]>> m_slabs;
+    //empty lists point at themselves
+    link m_wheel[s_levels][s_slots];
+
+    static void s_init(link& l) noexcept
+    {
+        l.m_prev = &l;
+        l.m_next = &l;
+    }
+
+    static bool s_empty(const link& l) noexcept
+    {
+        return l.m_next == &l;
+    }
+
+    static void s_push_back(link& l, link* n) noexcept
+    {
+        n->m_prev = l.m_prev;
+        n->m_next = &l;
+        l.m_prev->m_next = n;
+        l.m_prev = n;
+    }
+
+    static void s_unlink(link* n) noexcept
+    {
+        n->m_prev->m_next = n->m_next;
+        n->m_next->m_prev = n->m_prev;
+        n->m_prev = nullptr;
+    }
+
+    //moves all of src to the end of dst
+    static void s_splice(link& dst, link& src) noexcept
+    {
+        if(s_empty(src))
+        {
+            return;
+        }
+        src.m_next->m_prev = dst.m_prev;
+        dst.m_prev->m_next = src.m_next;
+        src.m_prev->m_next = &dst;
+        dst.m_prev = src.m_prev;
+        s_init(src);
+    }
+
+    node* allocate()
+    {
+        if(!m_free)
+        {
+            m_slabs.reserve(m_slabs.size() + 1);
+            m_slabs.emplace_back(new node[s_slab]);
+            auto slab = m_slabs.back().get();
+            for(std::size_t i = 0; i < s_slab; ++i)
+            {
+                slab[i].m_prev = nullptr;
+                slab[i].m_next = i + 1 < s_slab ? &slab[i + 1] : nullptr;
+                slab[i].m_generation = 0;
+            }
+            m_free = slab;
+        }
+        auto n = m_free;
+        m_free = static_cast<node*>(n->m_next);
+        return n;
+    }
+
+    void deallocate(node* n) noexcept
+    {
+        n->m_func.reset();
+        ++n->m_generation;
+        n->m_next = m_free;
+        m_free = n;
+    }
+
+    //the level is chosen by how far the deadline is, the slot by the deadline itself
+    void place(node* n) noexcept
+    {
+        auto deadline = n->m_deadline;
+        auto delay = deadline - m_now;
+        if(deadline < m_now)
+        {
+            deadline = m_now;
+            delay = 0;
+        }
+        else if(delay > s_max_delay)
+        {
+            deadline = m_now + s_max_delay;
+            delay = s_max_delay;
+        }
+        std::size_t level = 0;
+        while(delay >= (std::uint64_t(1) << (s_bits * (level + 1))))
+        {
+            ++level;
+        }
+        n->m_level = std::uint8_t(level);
+        ++m_counts[level];
+        s_push_back(m_wheel[level][(deadline >> (s_bits * level)) & s_mask], n);
+    }
+
+    //places the timers of a slot of a higher level again, returns the index of the slot
+    std::size_t cascade(std::size_t level) noexcept
+    {
+        auto index = (m_now >> (s_bits * level)) & s_mask;
+        link due;
+        s_init(due);
+        s_splice(due, m_wheel[level][index]);
+        while(!s_empty(due))
+        {
+            auto n = static_cast<node*>(due.m_next);
+            s_unlink(n);
+            --m_counts[level];
+            place(n);
+        }
+        return index;
+    }
+
+    template <typename F>
+    node* prepare(std::uint64_t delay, F&& f)
+    {
+        auto n = allocate();
+        try
+        {
+            f(n->m_func);
+        }
+        catch(...)
+        {
+            deallocate(n);
+            throw;
+        }
+        //a delay of 0 fires at the next tick, one past the end of time at the last tick
+        delay = std::max<std::uint64_t>(delay, 1);
+        n->m_deadline = delay > UINT64_MAX - m_now ? UINT64_MAX : m_now + delay;
+        place(n);
+        ++m_size;
+        return n;
+    }
+
+public:
+    //identifies a scheduled timer, stays harmless after the timer has fired or was cancelled
+    class handle
+    {
+        friend class timer_wheel;
+
+        node* m_node = nullptr;
+        std::uint32_t m_generation = 0;
+
+        handle(node* n) noexcept :
+            m_node(n), m_generation(n->m_generation)
+        {
+
+        }
+    public:
+        handle() noexcept = default;
+    };
+
+    explicit timer_wheel(std::uint64_t now = 0) :
+        m_now(now), m_size(0), m_counts(), m_free(nullptr)
+    {
+        for(auto& level : m_wheel)
+        {
+            for(auto& l : level)
+            {
+                s_init(l);
+            }
+        }
+    }
+
+    //the lists point into the object
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+    std::uint64_t now() const noexcept
+    {
+        return m_now;
+    }
+
+    //timers which are scheduled
+    std::size_t size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    //fires once the wheel has advanced by delay ticks
+    template <typename T, typename... TArgs>
+    handle emplace(std::uint64_t delay, TArgs&&... args)
+    {
+        return prepare(delay, [&](value_type& f) { f.template emplace<T>(std::forward<TArgs>(args)...); });
+    }
+
+    template <typename T>
+    handle schedule(std::uint64_t delay, T&& t)
+    {
+        using DT = std::decay_t<T>;
+        //wrappers are adopted, anything else is built in the node
+        if constexpr(std::is_same_v<DT, value_type> ||
+                     !std::is_constructible_v<value_type, std::in_place_type_t<DT>, T&&>)
+        {
+            return prepare(delay, [&](value_type& f) { f = value_type(std::forward<T>(t)); });
+        }
+        else
+        {
+            return emplace<DT>(delay, std::forward<T>(t));
+        }
+    }
+
+    //false if the timer has already fired, is firing or was cancelled
+    bool cancel(handle h) noexcept
+    {
+        auto n = h.m_node;
+        if(!n || n->m_generation != h.m_generation || !n->m_prev)
+        {
+            return false;
+        }
+        s_unlink(n);
+        --m_counts[n->m_level];
+        deallocate(n);
+        --m_size;
+        return true;
+    }
+
+    //moves time forward and fires what is due, tick by tick while there are timers in the first level,
+    //otherwise a slot of the lowest occupied level at a time. time stops at the largest tick.
+    //the callables may schedule and cancel timers. if one throws, advance stops there
+    //and the timers due with it fire at the next advance. returns how many fired
+    std::size_t advance(std::uint64_t ticks)
+    {
+        std::size_t fired = 0;
+        auto target = ticks > UINT64_MAX - m_now ? UINT64_MAX : m_now + ticks;
+        while(m_now < target)
+        {
+            if(m_size == 0)
+            {
+                m_now = target;
+                break;
+            }
+            //the first level is empty, nothing fires before the lowest occupied one comes down a slot
+            if(m_counts[0] == 0)
+            {
+                std::size_t level = 1;
+                while(m_counts[level] == 0)
+                {
+                    ++level;
+                }
+                m_now = std::min(m_now | ((std::uint64_t(1) << (s_bits * level)) - 1), target);
+                if(m_now == target)
+                {
+                    break;
+                }
+            }
+            ++m_now;
+            //once a level wraps, the next one comes down a slot.
+            //lower levels first, what comes from a higher one never lands in the slot just emptied
+            if((m_now & s_mask) == 0)
+            {
+                for(std::size_t level = 1; level < s_levels && cascade(level) == 0; ++level)
+                {
+
+                }
+            }
+            auto& slot = m_wheel[0][m_now & s_mask];
+            if(s_empty(slot))
+            {
+                continue;
+            }
+            //a batch, so timers scheduled meanwhile wait for their own tick
+            link due;
+            s_init(due);
+            s_splice(due, slot);
+            while(!s_empty(due))
+            {
+                auto n = static_cast<node*>(due.m_next);
+                s_unlink(n);
+                --m_counts[0];
+                --m_size;
+                try
+                {
+                    n->m_func();
+                }
+                catch(...)
+                {
+                    deallocate(n);
+                    s_splice(slot, due);
+                    --m_now;
+                    throw;
+                }
+                deallocate(n);
+                ++fired;
+            }
+        }
+        return fired;
+    }
+};
+
+}
@@ -3,11 +3,81 @@
 #include <cstring>
 #include <cstddef>
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include "func_view.hpp"
+#include "instrumentation.hpp"
+#include "relocatable.hpp"
 
 namespace vv6
 {
 
+inline constexpr std::size_t default_capacity = 2 * sizeof(std::max_align_t);
+inline constexpr std::size_t default_alignment = alignof(std::max_align_t);
+
+//how the wrappers reach the erased operations: the invoker and a pointer to the manager entry next to the storage,
+//or a single pointer to a static table per callable type, one indirection more per call
+struct inline_layout {};
+struct vtable_layout {};
+
+//where callables which do not fit into the storage go, the default is a plain new and delete.
+//a replacement provides s_allocate(size, align) and s_deallocate(ptr, size, align)
+struct new_heap
+{
+    static void* s_allocate(std::size_t size, std::size_t align)
+    {
+        if(align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            return ::operator new(size, std::align_val_t(align));
+        }
+        return ::operator new(size);
+    }
+
+    static void s_deallocate(void* ptr, std::size_t size, std::size_t align) noexcept
+    {
+        if(align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            ::operator delete(ptr, size, std::align_val_t(align));
+        }
+        else
+        {
+            ::operator delete(ptr, size);
+        }
+    }
+};
+
+//what becomes of a callable its wrapper lets go of, this one destroys it right away.
+//a replacement provides s_retire(manage, relocatable, storage, size, align), see func_reclaimer
+struct immediate_reclaimer {};
+
+//customization point of the owning wrappers, derive from it and override what differs.
+//defining VV6_INSTRUMENT counts for all wrappers which do not pick their own instrumentation
+struct default_policy
+{
+    using layout = inline_layout;
+    using heap = new_heap;
+    using reclaimer = immediate_reclaimer;
+#ifdef VV6_INSTRUMENT
+    using instrumentation = counting_instrumentation<true>;
+#else
+    using instrumentation = no_instrumentation;
+#endif
+};
+
+struct vtable_policy : default_policy
+{
+    using layout = vtable_layout;
+};
+
+//a resource which is released as a whole, like a monotonic_buffer_resource,
+//so the wrappers destroy their callables but never hand the memory back
+struct releasable_resource
+{
+    std::pmr::memory_resource* resource;
+
+    explicit releasable_resource(std::pmr::memory_resource* r) noexcept : resource(r) {}
+};
+
 namespace uf_details
 {
 
@@ -23,28 +93,48 @@ static constexpr bool must_be_implicit_lifetime_type =
         std::is_trivially_move_constructible_v<T> &&
         std::is_trivially_copy_constructible_v<T>;
 
-using storage_type = std::aligned_storage_t<2 * sizeof(std::max_align_t), alignof(std::max_align_t)>;
+template <std::size_t Size, std::size_t Align>
+using basic_storage = std::aligned_storage_t<Size, Align>;
 
-using manager_type = void(*)(storage_type*, storage_type*) noexcept;
+using storage_type = basic_storage<default_capacity, default_alignment>;
 
-template <typename T>
+enum class manage_op
+{
+    move,
+    copy,
+    destroy
+};
+
+//managers and invokers only see the address of the storage,
+//so they can be shared by storages of different capacities.
+//only copy may throw, and it is only requested for copyable objects
+using manager_type = void(*)(manage_op, void*, void*);
+
+template <typename T, typename Storage = storage_type>
 static constexpr bool is_inplace =
-        (sizeof(T) <= sizeof(storage_type)) &&
-        (alignof (storage_type) >= alignof (T)) &&
-        (alignof (storage_type) % alignof (T) == 0) &&
+        (sizeof(T) <= sizeof(Storage)) &&
+        (alignof (Storage) >= alignof (T)) &&
+        (alignof (Storage) % alignof (T) == 0) &&
         std::is_nothrow_move_constructible<T>::value;
 
 template <typename T>
 struct external_manager
 {
-    static void s_manage(storage_type* src, storage_type* dst) noexcept
+    static void s_manage(manage_op op, void* src, void* dst)
     {
         auto s = launder_cast<T**>(src);
-        if(dst)
+        if(op == manage_op::move)
         {
             *launder_cast<T**>(dst) = *s;
             *s = nullptr;
         }
+        else if(op == manage_op::copy)
+        {
+            if constexpr(std::is_copy_constructible_v<T>)
+            {
+                new (dst) T*(new T(std::as_const(**s)));
+            }
+        }
         else
         {
             delete *s;
@@ -52,6 +142,56 @@ struct external_manager
     }
 };
 
+//callables on a heap other than new_heap
+template <typename T, typename Heap>
+struct heap_manager
+{
+    template <typename... Args>
+    static T* s_create(Args&& ...args)
+    {
+        void* p = Heap::s_allocate(sizeof(T), alignof(T));
+        if constexpr(std::is_nothrow_constructible_v<T, Args&&...>)
+        {
+            return new (p) T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            try
+            {
+                return new (p) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                Heap::s_deallocate(p, sizeof(T), alignof(T));
+                throw;
+            }
+        }
+    }
+
+    static void s_manage(manage_op op, void* src, void* dst)
+    {
+        auto s = launder_cast<T**>(src);
+        if(op == manage_op::move)
+        {
+            *launder_cast<T**>(dst) = *s;
+            *s = nullptr;
+        }
+        else if(op == manage_op::copy)
+        {
+            if constexpr(std::is_copy_constructible_v<T>)
+            {
+                new (dst) T*(s_create(std::as_const(**s)));
+            }
+        }
+        else
+        {
+            auto p = *s;
+            p->~T();
+            Heap::s_deallocate(p, sizeof(T), alignof(T));
+        }
+    }
+};
+
 template <typename Alloc, typename = void>
 struct with_allocator_base;
 
@@ -107,19 +247,39 @@ struct with_allocator : with_allocator_base<Alloc>
 template <typename T, typename Alloc>
 struct external_manager<with_allocator<T, Alloc>>
 {
-    static void s_manage(storage_type* src, storage_type* dst) noexcept
+    using A = typename std::allocator_traits<Alloc>
+    ::template rebind_alloc<with_allocator<T, Alloc>>;
+
+    static void s_manage(manage_op op, void* src, void* dst)
     {
         auto s = launder_cast<with_allocator<T, Alloc>**>(src);
-        if(dst)
+        if(op == manage_op::move)
         {
             *launder_cast<with_allocator<T, Alloc>**>(dst) = *s;
             *s = nullptr;
         }
+        else if(op == manage_op::copy)
+        {
+            if constexpr(std::is_copy_constructible_v<T>)
+            {
+                auto p = *s;
+                A alloc(p->get_allocator());
+                auto q = std::allocator_traits<A>::allocate(alloc, 1);
+                try
+                {
+                    std::allocator_traits<A>::construct(alloc, q, p->get_allocator(), std::as_const(p->t_));
+                }
+                catch (...)
+                {
+                    std::allocator_traits<A>::deallocate(alloc, q, 1);
+                    throw;
+                }
+                new (dst) with_allocator<T, Alloc>*(q);
+            }
+        }
         else
         {
             auto p = *s;
-            using A = typename std::allocator_traits<Alloc>
-            ::template rebind_alloc<with_allocator<T, Alloc>>;
             A alloc(p->get_allocator());
             std::allocator_traits<A>::destroy(alloc, p);
             std::allocator_traits<A>::deallocate(alloc, p, 1);
@@ -127,17 +287,149 @@ struct external_manager<with_allocator<T, Alloc>>
     }
 };
 
+//only the resource pointer is kept in the block
+template <typename T, bool Releasable>
+struct with_resource
+{
+    std::pmr::memory_resource* resource_;
+    T t_;
+
+    template <typename... Args>
+    with_resource(std::pmr::memory_resource* resource, Args&& ...args) :
+        resource_(resource), t_(std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename... Args>
+    decltype(auto) operator()(Args&& ...args)
+    {
+        return t_(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    decltype(auto) operator()(Args&& ...args) const
+    {
+        return t_(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    static with_resource* s_create(std::pmr::memory_resource* resource, Args&& ...args)
+    {
+        void* p = resource->allocate(sizeof(with_resource), alignof(with_resource));
+        if constexpr(std::is_nothrow_constructible_v<T, Args&&...>)
+        {
+            return new (p) with_resource(resource, std::forward<Args>(args)...);
+        }
+        else
+        {
+            try
+            {
+                return new (p) with_resource(resource, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                resource->deallocate(p, sizeof(with_resource), alignof(with_resource));
+                throw;
+            }
+        }
+    }
+};
+
+template <typename T, bool Releasable>
+struct external_manager<with_resource<T, Releasable>>
+{
+    using type = with_resource<T, Releasable>;
+
+    static void s_manage(manage_op op, void* src, void* dst)
+    {
+        auto s = launder_cast<type**>(src);
+        if(op == manage_op::move)
+        {
+            *launder_cast<type**>(dst) = *s;
+            *s = nullptr;
+        }
+        else if(op == manage_op::copy)
+        {
+            if constexpr(std::is_copy_constructible_v<T>)
+            {
+                new (dst) type*(type::s_create((*s)->resource_, std::as_const((*s)->t_)));
+            }
+        }
+        else
+        {
+            auto p = *s;
+            auto r = p->resource_;
+            p->~type();
+            if constexpr(!Releasable)
+            {
+                r->deallocate(p, sizeof(type), alignof(type));
+            }
+        }
+    }
+};
+
+//memory resources are taken by pointer, polymorphic allocators are reduced to theirs
+template <typename Alloc, typename = void>
+struct resource_traits
+{
+    static constexpr bool is_resource = false;
+};
+
+template <typename R>
+struct resource_traits<R*, std::enable_if_t<std::is_base_of_v<std::pmr::memory_resource, R>>>
+{
+    static constexpr bool is_resource = true;
+    static constexpr bool releasable = false;
+
+    static std::pmr::memory_resource* get(R* r) noexcept
+    {
+        return r;
+    }
+};
+
+template <typename U>
+struct resource_traits<std::pmr::polymorphic_allocator<U>>
+{
+    static constexpr bool is_resource = true;
+    static constexpr bool releasable = false;
+
+    static std::pmr::memory_resource* get(const std::pmr::polymorphic_allocator<U>& a) noexcept
+    {
+        return a.resource();
+    }
+};
+
+template <>
+struct resource_traits<releasable_resource>
+{
+    static constexpr bool is_resource = true;
+    static constexpr bool releasable = true;
+
+    static std::pmr::memory_resource* get(const releasable_resource& r) noexcept
+    {
+        return r.resource;
+    }
+};
+
 template <typename T>
 struct internal_manager
 {
-    static void s_manage(storage_type* src, storage_type* dst) noexcept
+    static void s_manage(manage_op op, void* src, void* dst)
     {
         auto s = launder_cast<T*>(src);
-        if(dst)
+        if(op == manage_op::move)
         {
             new(dst) T(std::move(*s));
             s->~T();
         }
+        else if(op == manage_op::copy)
+        {
+            if constexpr(std::is_copy_constructible_v<T>)
+            {
+                new(dst) T(std::as_const(*s));
+            }
+        }
         else
         {
             s->~T();
@@ -146,28 +438,28 @@ struct internal_manager
 };
 
 template <typename T, bool Const, bool External>
-decltype(auto) storage_cast(const storage_type& obj)
+decltype(auto) storage_cast(const void* obj)
 {
     if constexpr(External)
     {
         if constexpr(Const)
         {
-            return **launder_cast<const T* const *>(&obj);
+            return **launder_cast<const T* const *>(obj);
         }
         else
         {
-            return *const_cast<T*>(*launder_cast<const T* const *>(&obj));
+            return *const_cast<T*>(*launder_cast<const T* const *>(obj));
         }
     }
     else
     {
         if constexpr(Const)
         {
-            return *launder_cast<const T*>(&obj);
+            return *launder_cast<const T*>(obj);
         }
         else
         {
-            return *const_cast<T*>(launder_cast<const T*>(&obj));
+            return *const_cast<T*>(launder_cast<const T*>(obj));
         }
     }
 }
@@ -175,81 +467,410 @@ decltype(auto) storage_cast(const storage_type& obj)
 template <typename Sig, typename T, bool External>
 struct invoker;
 
-template <typename Ret, typename... Args, typename T, bool External>
-struct invoker<Ret(Args...) const, T, External>
+template <typename Ret, typename... Args, bool NE, typename T, bool External>
+struct invoker<Ret(Args...) const noexcept(NE), T, External>
 {
-    static Ret s_invoke(const storage_type& obj, details::argument_t<Args>... args)
+    static Ret s_invoke(const void* obj, details::argument_t<Args>... args) noexcept(NE)
     {
 
         return static_cast<Ret>(storage_cast<T, true, External>(obj)(std::forward<Args>(args)...));
     }
 };
 
-template <typename Ret, typename... Args, typename T, bool External>
-struct invoker<Ret(Args...), T, External>
+template <typename Ret, typename... Args, bool NE, typename T, bool External>
+struct invoker<Ret(Args...) noexcept(NE), T, External>
 {
-    static Ret s_invoke(const storage_type& obj, details::argument_t<Args>... args)
+    static Ret s_invoke(const void* obj, details::argument_t<Args>... args) noexcept(NE)
     {
 
         return static_cast<Ret>(storage_cast<T, false, External>(obj)(std::forward<Args>(args)...));
     }
 };
 
+//what the wrappers keep to reach the invokers, a function pointer for a single signature
+//and a pointer to a static table for overloads.
+//noexcept is dropped so that all flavours of a signature share one base and can adopt each other
 template <typename Sig>
+struct erased_invoker;
+
+template <typename Ret, typename... Args, bool NE>
+struct erased_invoker<Ret(Args...) noexcept(NE)>
+{
+    using type = Ret (*)(const void* obj, details::argument_t<Args>... args);
+};
+
+template <typename Ret, typename... Args, bool NE>
+struct erased_invoker<Ret(Args...) const noexcept(NE)> : erased_invoker<Ret(Args...)> {};
+
+template <typename... Sigs>
+struct erased_invoker<overload<Sigs...>>
+{
+    using type = const std::tuple<typename erased_invoker<Sigs>::type...>*;
+};
+
+//the invokers of noexcept signatures are noexcept, this gives their type back before the call
+template <typename Invoker>
+struct restore_noexcept;
+
+template <typename Ret, typename... Params>
+struct restore_noexcept<Ret (*)(Params...)>
+{
+    using type = Ret (*)(Params...) noexcept;
+};
+
+//a variable template trips gcc 12 on noexcept signatures
+template <typename T, bool External, typename... Sigs>
+struct overload_table
+{
+    static constexpr std::tuple<typename erased_invoker<Sigs>::type...> value{&invoker<Sigs, T, External>::s_invoke...};
+};
+
+template <typename Sig, typename T, bool External>
+struct invoker_of
+{
+    static constexpr typename erased_invoker<Sig>::type value = &invoker<Sig, T, External>::s_invoke;
+};
+
+template <typename... Sigs, typename T, bool External>
+struct invoker_of<overload<Sigs...>, T, External>
+{
+    static constexpr typename erased_invoker<overload<Sigs...>>::type value = &overload_table<T, External, Sigs...>::value;
+};
+
+//relocatable storages are moved with memcpy, their manager is only asked to copy and destroy
+struct manager_entry
+{
+    manager_type manage;
+    bool relocatable;
+};
+
+template <manager_type M, bool Relocatable>
+struct manager_entry_for
+{
+    static constexpr manager_entry value{M, Relocatable};
+};
+
+template <typename Invoker>
+struct vtable
+{
+    Invoker invoke;
+    manager_type manage;
+    bool relocatable;
+};
+
+template <typename Invoker, Invoker I, manager_type M, bool Relocatable>
+inline constexpr vtable<Invoker> vtable_for{I, M, Relocatable};
+
+template <typename Layout, typename Invoker>
+class erased_ops;
+
+template <typename Invoker>
+class erased_ops<inline_layout, Invoker>
+{
+    Invoker m_invoker;
+    //null for trivial objects
+    const manager_entry* m_manager;
+public:
+    constexpr erased_ops() noexcept :
+        m_invoker(nullptr),
+        m_manager(nullptr)
+    {
+
+    }
+
+    //member-wise, a single wide load right after set() stalls on store forwarding
+    erased_ops(const erased_ops& other) noexcept :
+        m_invoker(other.m_invoker),
+        m_manager(other.m_manager)
+    {
+
+    }
+
+    erased_ops& operator=(const erased_ops& other) noexcept
+    {
+        m_invoker = other.m_invoker;
+        m_manager = other.m_manager;
+        return *this;
+    }
+
+    //for objects which need no manager
+    template <Invoker I>
+    void set() noexcept
+    {
+        m_invoker = I;
+        m_manager = nullptr;
+    }
+
+    template <Invoker I, manager_type M, bool Relocatable>
+    void set() noexcept
+    {
+        m_invoker = I;
+        m_manager = &manager_entry_for<M, Relocatable>::value;
+    }
+
+    Invoker invoker() const noexcept
+    {
+        return m_invoker;
+    }
+
+    manager_type manager() const noexcept
+    {
+        return m_manager ? m_manager->manage : nullptr;
+    }
+
+    bool relocatable() const noexcept
+    {
+        return !m_manager || m_manager->relocatable;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_invoker != nullptr;
+    }
+};
+
+template <typename Invoker>
+class erased_ops<vtable_layout, Invoker>
+{
+    const vtable<Invoker>* m_table;
+public:
+    constexpr erased_ops() noexcept :
+        m_table(nullptr)
+    {
+
+    }
+
+    template <Invoker I>
+    void set() noexcept
+    {
+        m_table = &vtable_for<Invoker, I, nullptr, true>;
+    }
+
+    template <Invoker I, manager_type M, bool Relocatable>
+    void set() noexcept
+    {
+        m_table = &vtable_for<Invoker, I, M, Relocatable>;
+    }
+
+    //only asked for when not empty
+    Invoker invoker() const noexcept
+    {
+        return m_table->invoke;
+    }
+
+    manager_type manager() const noexcept
+    {
+        return m_table ? m_table->manage : nullptr;
+    }
+
+    bool relocatable() const noexcept
+    {
+        return !m_table || m_table->relocatable;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_table != nullptr;
+    }
+};
+
+template <typename T, typename Sig>
+struct invocable_as;
+
+template <typename T, typename Ret, typename... Args, bool NE>
+struct invocable_as<T, Ret(Args...) noexcept(NE)> : std::bool_constant<details::invocable_r<NE, Ret, T&, Args&&...>> {};
+
+template <typename T, typename Ret, typename... Args, bool NE>
+struct invocable_as<T, Ret(Args...) const noexcept(NE)> : std::bool_constant<details::invocable_r<NE, Ret, const T&, Args&&...>> {};
+
+//whether inv is one a wrapper with this erased signature stores for U, which holds the callable T.
+//all flavours of the signature are tried, since the wrappers adopt each other
+template <typename Sig, typename T, typename U, bool External>
+struct target_match;
+
+template <typename Ret, typename... Args, typename T, typename U, bool External>
+struct target_match<Ret(Args...), T, U, External>
+{
+    template <typename CallSig, bool Callable>
+    static bool s_is(typename erased_invoker<Ret(Args...)>::type inv) noexcept
+    {
+        if constexpr(Callable)
+        {
+            return inv == invoker_of<CallSig, U, External>::value;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    static bool s_match(typename erased_invoker<Ret(Args...)>::type inv) noexcept
+    {
+        return s_is<Ret(Args...), details::invocable_r<false, Ret, T&, Args&&...>>(inv) ||
+               s_is<Ret(Args...) const, details::invocable_r<false, Ret, const T&, Args&&...>>(inv) ||
+               s_is<Ret(Args...) noexcept, details::invocable_r<true, Ret, T&, Args&&...>>(inv) ||
+               s_is<Ret(Args...) const noexcept, details::invocable_r<true, Ret, const T&, Args&&...>>(inv);
+    }
+};
+
+template <typename... Sigs, typename T, typename U, bool External>
+struct target_match<overload<Sigs...>, T, U, External>
+{
+    static bool s_match(typename erased_invoker<overload<Sigs...>>::type inv) noexcept
+    {
+        if constexpr((invocable_as<T, Sigs>::value && ...))
+        {
+            return inv == invoker_of<overload<Sigs...>, U, External>::value;
+        }
+        else
+        {
+            return false;
+        }
+    }
+};
+
+//the signature a wrapper calls with, from its erased one
+template <typename Sig, bool Const, bool NE>
+struct call_signature
+{
+    using type = Sig;
+};
+
+template <typename Ret, typename... Args, bool Const, bool NE>
+struct call_signature<Ret(Args...), Const, NE>
+{
+    using type = std::conditional_t<Const, Ret(Args...) const noexcept(NE), Ret(Args...) noexcept(NE)>;
+};
+
+template <typename T, typename... Ts, typename F, typename... A>
+decltype(auto) visit_as(F& f, A&& ...args);
+
+template <typename Sig, std::size_t Size = default_capacity, std::size_t Align = default_alignment,
+          typename Policy = default_policy>
 class unique_func_base;
 
-template <typename Ret, typename... Args>
-class unique_func_base<Ret(Args...)>
+//Sig is the signature without const, or an overload
+template <typename Sig, std::size_t Size, std::size_t Align, typename Policy>
+class unique_func_base
 {
-    Ret (*m_invoker)(const storage_type& obj, details::argument_t<Args>... args);
-    manager_type m_manager;
-    storage_type m_storage;
+    template <typename, std::size_t, std::size_t, typename>
+    friend class unique_func_base;
+
+    template <typename T, typename... Ts, typename F, typename... A>
+    friend decltype(auto) visit_as(F& f, A&& ...args);
+
+    using storage = basic_storage<Size, Align>;
+    using invoker_type = typename erased_invoker<Sig>::type;
+
+    erased_ops<typename Policy::layout, invoker_type> m_ops;
+    storage m_storage;
+
+    void destroy() noexcept
+    {
+        if(auto manager = m_ops.manager())
+        {
+            if constexpr(std::is_same_v<typename Policy::reclaimer, immediate_reclaimer>)
+            {
+                manager(manage_op::destroy, &m_storage, nullptr);
+            }
+            else
+            {
+                Policy::reclaimer::s_retire(manager, m_ops.relocatable(), &m_storage, sizeof(storage), alignof(storage));
+            }
+        }
+    }
+
+    template <std::size_t OSize, std::size_t OAlign>
+    void steal(unique_func_base<Sig, OSize, OAlign, Policy>& other) noexcept
+    {
+        m_ops = other.m_ops;
+        if(m_ops.relocatable())
+        {
+            //redundant in empty case
+            std::memcpy(&m_storage, &other.m_storage, sizeof(other.m_storage));
+        }
+        else
+        {
+            m_ops.manager()(manage_op::move, &other.m_storage, &m_storage);
+        }
+        other.m_ops = {};
+    }
+
+    using instrumentation = typename Policy::instrumentation;
+
+    //counted before the construction, a throwing one is counted as well
+    template <typename DT>
+    static void instrument_construct(bool allocator) noexcept
+    {
+        auto path = construct_path::inline_storage;
+        if(!is_inplace<DT, storage>)
+        {
+            path = allocator ? construct_path::allocator : construct_path::external;
+        }
+        instrumentation::template s_construct<Sig>(path, sizeof(DT));
+    }
 protected:
-    template <typename Sig, typename DT, typename... DTArgs>
+    template <std::size_t OSize, std::size_t OAlign>
+    static constexpr bool can_adopt = (OSize <= Size) && (OAlign <= Align);
+
+    template <typename CallSig, typename DT, typename... DTArgs>
     static constexpr void construct(unique_func_base* self, DTArgs&& ...args)
     {
-        if constexpr(must_be_implicit_lifetime_type<DT>)
+        instrument_construct<DT>(false);
+        if constexpr(must_be_implicit_lifetime_type<DT> && is_inplace<DT, storage>)
         {
-            self->m_invoker = invoker<Sig, DT, false>::s_invoke;
-            self->m_manager = nullptr;
             new(&self->m_storage) DT(std::forward<DTArgs>(args)...);
+            self->m_ops.template set<invoker_of<CallSig, DT, false>::value>();
         }
-        else if constexpr(is_inplace<DT>)
+        else if constexpr(is_inplace<DT, storage>)
         {
-            self->m_invoker = invoker<Sig, DT, false>::s_invoke;
-            self->m_manager = internal_manager<DT>::s_manage;
             new (&self->m_storage) DT(std::forward<DTArgs>(args)...);
+            self->m_ops.template set<invoker_of<CallSig, DT, false>::value, internal_manager<DT>::s_manage,
+                    is_trivially_relocatable_v<DT>>();
         }
-        else
+        else if constexpr(std::is_same_v<typename Policy::heap, new_heap>)
         {
-            self->m_invoker = invoker<Sig, DT, true>::s_invoke;
-            self->m_manager = external_manager<DT>::s_manage;
+            static_assert(is_inplace<DT*, storage>, "the storage must be able to hold a pointer");
             new (&self->m_storage) DT*(new DT(std::forward<DTArgs>(args)...));
+            self->m_ops.template set<invoker_of<CallSig, DT, true>::value, external_manager<DT>::s_manage, true>();
+        }
+        else
+        {
+            static_assert(is_inplace<DT*, storage>, "the storage must be able to hold a pointer");
+            using manager = heap_manager<DT, typename Policy::heap>;
+            new (&self->m_storage) DT*(manager::s_create(std::forward<DTArgs>(args)...));
+            self->m_ops.template set<invoker_of<CallSig, DT, true>::value, manager::s_manage, true>();
         }
     }
 
-    template <typename Sig, typename DT, typename Alloc, typename... DTArgs>
+    template <typename CallSig, typename DT, typename Alloc, typename... DTArgs>
     static void construct(unique_func_base* self, std::allocator_arg_t, Alloc&& alloc, DTArgs&& ...args)
     {
-        if constexpr(must_be_implicit_lifetime_type<DT>)
+        instrument_construct<DT>(true);
+        if constexpr(must_be_implicit_lifetime_type<DT> && is_inplace<DT, storage>)
         {
-            self->m_invoker = invoker<Sig, DT, false>::s_invoke;
-            self->m_manager = nullptr;
             new(&self->m_storage) DT(std::forward<DTArgs>(args)...);
+            self->m_ops.template set<invoker_of<CallSig, DT, false>::value>();
         }
-        else if constexpr(is_inplace<DT>)
+        else if constexpr(is_inplace<DT, storage>)
         {
-            self->m_invoker = invoker<Sig, DT, false>::s_invoke;
-            self->m_manager = internal_manager<DT>::s_manage;
             new (&self->m_storage) DT(std::forward<DTArgs>(args)...);
+            self->m_ops.template set<invoker_of<CallSig, DT, false>::value, internal_manager<DT>::s_manage,
+                    is_trivially_relocatable_v<DT>>();
+        }
+        else if constexpr(resource_traits<std::decay_t<Alloc>>::is_resource)
+        {
+            static_assert(is_inplace<DT*, storage>, "the storage must be able to hold a pointer");
+            using traits = resource_traits<std::decay_t<Alloc>>;
+            using type = with_resource<DT, traits::releasable>;
+            new (&self->m_storage) type*(type::s_create(traits::get(alloc), std::forward<DTArgs>(args)...));
+            self->m_ops.template set<invoker_of<CallSig, type, true>::value, external_manager<type>::s_manage, true>();
         }
         else
         {
+            static_assert(is_inplace<DT*, storage>, "the storage must be able to hold a pointer");
             using Allocator = std::decay_t<Alloc>;
             using type = with_allocator<DT, Allocator>;
-            self->m_invoker = invoker<Sig, type, true>::s_invoke;
-            self->m_manager = external_manager<type>::s_manage;
-
             using A = typename std::allocator_traits<Allocator>
             ::template rebind_alloc<type>;
             A a(alloc);
@@ -271,58 +892,142 @@ protected:
                 }
             }
             new (&self->m_storage) type*(p);
+            self->m_ops.template set<invoker_of<CallSig, type, true>::value, external_manager<type>::s_manage, true>();
         }
     }
 
-    Ret call(Args&& ...args) const
+    //the other storage must not be larger, so inplace objects stay inplace
+    //and external objects only hand over their pointer
+    template <std::size_t OSize, std::size_t OAlign>
+    void adopt(unique_func_base<Sig, OSize, OAlign, Policy>&& other) noexcept
     {
-        return m_invoker(m_storage, std::forward<Args>(args)...);
+        static_assert(can_adopt<OSize, OAlign>);
+        instrumentation::template s_move<Sig>();
+        destroy();
+        steal(other);
     }
-public:
-    constexpr unique_func_base() noexcept:
-        m_invoker(nullptr),
-        m_manager(nullptr),
-        m_storage()
-    {
 
+    //*this must be empty
+    template <std::size_t OSize, std::size_t OAlign>
+    void copy_from(const unique_func_base<Sig, OSize, OAlign, Policy>& other)
+    {
+        static_assert(can_adopt<OSize, OAlign>);
+        if(auto manager = other.m_ops.manager())
+        {
+            manager(manage_op::copy, const_cast<void*>(static_cast<const void*>(&other.m_storage)), &m_storage);
+        }
+        else
+        {
+            std::memcpy(&m_storage, &other.m_storage, sizeof(other.m_storage));
+        }
+        m_ops = other.m_ops;
     }
 
-    unique_func_base(const unique_func_base&) = delete;
+    template <bool NE = false, typename... A>
+    decltype(auto) call(A&& ...args) const noexcept(NE)
+    {
+        instrumentation::template s_call<Sig>();
+        if constexpr(NE)
+        {
+            using type = typename restore_noexcept<invoker_type>::type;
+            return reinterpret_cast<type>(m_ops.invoker())(&m_storage, std::forward<A>(args)...);
+        }
+        else
+        {
+            return m_ops.invoker()(&m_storage, std::forward<A>(args)...);
+        }
+    }
 
-    unique_func_base(unique_func_base&& other) noexcept : m_invoker(other.m_invoker), m_manager(other.m_manager)
+    //only the invoker a T constructed right into such a wrapper gets, a single comparison
+    template <bool Const, bool NE, typename T>
+    T* exact_target() const noexcept
     {
-        if(m_manager)
+        constexpr bool external = !is_inplace<T, storage>;
+        //the vtable layout has no invoker to compare while empty
+        if(!m_ops || m_ops.invoker() != invoker_of<typename call_signature<Sig, Const, NE>::type, T, external>::value)
+        {
+            return nullptr;
+        }
+        void* s = const_cast<storage*>(&m_storage);
+        if constexpr(external)
         {
-            m_manager(&other.m_storage, &m_storage);
+            return *launder_cast<T**>(s);
         }
         else
         {
-            //redundant in empty case
-            std::memcpy(&m_storage, &other.m_storage, sizeof(m_storage));
+            return launder_cast<T*>(s);
         }
-        other.m_invoker = nullptr;
-        other.m_manager = nullptr;
     }
 
-    unique_func_base& operator=(unique_func_base&& other) noexcept
+    template <typename T>
+    T* target_ptr() const noexcept
     {
-        if(m_manager)
+        static_assert(std::is_same_v<T, std::decay_t<T>>, "the target is a decayed object type");
+        if(!m_ops)
         {
-            m_manager(&m_storage, nullptr);
+            return nullptr;
         }
-        m_invoker = other.m_invoker;
-        m_manager = other.m_manager;
-        if(m_manager)
+        auto inv = m_ops.invoker();
+        void* s = const_cast<storage*>(&m_storage);
+        //a callable which is external here was external wherever it was constructed
+        if constexpr(is_inplace<T, storage>)
+        {
+            if(target_match<Sig, T, T, false>::s_match(inv))
+            {
+                return launder_cast<T*>(s);
+            }
+        }
+        if(target_match<Sig, T, T, true>::s_match(inv))
+        {
+            return *launder_cast<T**>(s);
+        }
+        if(target_match<Sig, T, with_resource<T, false>, true>::s_match(inv))
         {
+            return &(*launder_cast<with_resource<T, false>**>(s))->t_;
+        }
+        if(target_match<Sig, T, with_resource<T, true>, true>::s_match(inv))
+        {
+            return &(*launder_cast<with_resource<T, true>**>(s))->t_;
+        }
+        return nullptr;
+    }
 
-            m_manager(&other.m_storage, &m_storage);
+    template <std::size_t I, bool NE = false, typename... A>
+    decltype(auto) call_at(A&& ...args) const noexcept(NE)
+    {
+        instrumentation::template s_call<Sig>();
+        auto f = std::get<I>(*m_ops.invoker());
+        if constexpr(NE)
+        {
+            using type = typename restore_noexcept<decltype(f)>::type;
+            return reinterpret_cast<type>(f)(&m_storage, std::forward<A>(args)...);
         }
         else
         {
-            std::memcpy(&m_storage, &other.m_storage, sizeof(m_storage));
+            return f(&m_storage, std::forward<A>(args)...);
         }
-        other.m_invoker = nullptr;
-        other.m_manager = nullptr;
+    }
+public:
+    constexpr unique_func_base() noexcept:
+        m_ops(),
+        m_storage()
+    {
+
+    }
+
+    unique_func_base(const unique_func_base&) = delete;
+
+    unique_func_base(unique_func_base&& other) noexcept
+    {
+        instrumentation::template s_move<Sig>();
+        steal(other);
+    }
+
+    unique_func_base& operator=(unique_func_base&& other) noexcept
+    {
+        instrumentation::template s_move_assign<Sig>();
+        destroy();
+        steal(other);
         return *this;
     }
 
@@ -330,95 +1035,315 @@ public:
 
     ~unique_func_base()
     {
-        if(m_manager)
-        {
-            m_manager(&m_storage, nullptr);
-        }
+        destroy();
+    }
+
+    void reset() noexcept
+    {
+        destroy();
+        m_ops = {};
     }
 
     explicit operator bool() const noexcept
     {
-        return m_invoker != nullptr;
+        return static_cast<bool>(m_ops);
+    }
+
+    //the callable if it is a T, compares the stored invoker with the ones of T, no RTTI involved.
+    //callables constructed with a standard allocator are not found
+    template <typename T>
+    T* target() noexcept
+    {
+        return target_ptr<T>();
+    }
+
+    template <typename T>
+    const T* target() const noexcept
+    {
+        return target_ptr<T>();
     }
 };
 
 }
 
+template <typename Sig, std::size_t Size = default_capacity, std::size_t Align = default_alignment,
+          typename Policy = default_policy>
+class basic_unique_func;
+
 template <typename Sig>
-class unique_func;
+using unique_func = basic_unique_func<Sig>;
 
-template <typename Ret, typename... Args>
-class unique_func<Ret(Args...)> : public uf_details::unique_func_base<Ret(Args...)>
+template <typename Ret, typename... Args, bool NE, std::size_t Size, std::size_t Align, typename Policy>
+class basic_unique_func<Ret(Args...) noexcept(NE), Size, Align, Policy> :
+        public uf_details::unique_func_base<Ret(Args...), Size, Align, Policy>
 {
-    using signature_type = Ret(Args ...);
-    using base_type = uf_details::unique_func_base<Ret(Args...)>;
+    using signature_type = Ret(Args ...) noexcept(NE);
+    using base_type = uf_details::unique_func_base<Ret(Args...), Size, Align, Policy>;
+
+    template <std::size_t OSize, std::size_t OAlign>
+    static std::bool_constant<base_type::template can_adopt<OSize, OAlign>>
+    s_adoptable(const uf_details::unique_func_base<Ret(Args...), OSize, OAlign, Policy>*);
+    static std::false_type s_adoptable(...);
+
     template <typename T>
-    static constexpr bool proper = !std::is_convertible_v<T*, unique_func*> &&
-            std::is_invocable_r_v<Ret, T&, Args&&...>;
+    static constexpr bool proper = !std::is_convertible_v<T*, basic_unique_func*> &&
+            !decltype(s_adoptable(std::declval<T*>()))::value &&
+            details::invocable_r<NE, Ret, T&, Args&&...>;
 public:
     using base_type::base_type;
 
     template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
-    unique_func(T&& t)
+    basic_unique_func(T&& t)
     {
         base_type::template construct<signature_type, std::decay_t<T>>(this, std::forward<T>(t));
     }
 
     template <typename Allocator, typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
-    unique_func(std::allocator_arg_t, const Allocator& a, T&& t)
+    basic_unique_func(std::allocator_arg_t, const Allocator& a, T&& t)
     {
         base_type::template construct<signature_type, std::decay_t<T>>(this, std::allocator_arg, a, std::forward<T>(t));
     }
 
     template <typename T, typename... DTArgs, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
-    unique_func(std::in_place_type_t<T>, DTArgs&&... args)
+    basic_unique_func(std::in_place_type_t<T>, DTArgs&&... args)
     {
         base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
     }
 
-    unique_func(unique_func<Ret(Args...) const>&& other) : base_type(std::move(other))
+    //from both const and non-const ones, as long as they are not larger
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign> && !NE, int> = 0>
+    basic_unique_func(uf_details::unique_func_base<Ret(Args...), OSize, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    //noexcept ones only adopt noexcept ones
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign> && NE, int> = 0>
+    basic_unique_func(basic_unique_func<Ret(Args...) noexcept, OSize, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign> && NE, int> = 0>
+    basic_unique_func(basic_unique_func<Ret(Args...) const noexcept, OSize, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    //constructs in place, without a temporary wrapper
+    template <typename T, typename... DTArgs, std::enable_if_t<proper<T>, int> = 0>
+    void emplace(DTArgs&&... args)
     {
+        base_type::reset();
+        base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
     }
 
-    Ret operator()(Args&& ...args)
+    Ret operator()(Args&& ...args) noexcept(NE)
     {
-        return base_type::call(std::forward<Args>(args)...);
+        return base_type::template call<NE>(std::forward<Args>(args)...);
     }
 };
 
-template <typename Ret, typename... Args>
-class unique_func<Ret(Args...) const> : public uf_details::unique_func_base<Ret(Args...)>
+template <typename Ret, typename... Args, bool NE, std::size_t Size, std::size_t Align, typename Policy>
+class basic_unique_func<Ret(Args...) const noexcept(NE), Size, Align, Policy> :
+        public uf_details::unique_func_base<Ret(Args...), Size, Align, Policy>
 {
-    using signature_type = Ret(Args ...) const;
-    using base_type = uf_details::unique_func_base<Ret(Args...)>;
+    using signature_type = Ret(Args ...) const noexcept(NE);
+    using base_type = uf_details::unique_func_base<Ret(Args...), Size, Align, Policy>;
+
+    template <std::size_t OSize, std::size_t OAlign, bool ONE>
+    static std::bool_constant<base_type::template can_adopt<OSize, OAlign>>
+    s_adoptable(const basic_unique_func<Ret(Args...) const noexcept(ONE), OSize, OAlign, Policy>*);
+    static std::false_type s_adoptable(...);
+
     template <typename T>
-    static constexpr bool proper = !std::is_convertible_v<T*, unique_func*> &&
-            std::is_invocable_r_v<Ret, const T&, Args&&...>;
+    static constexpr bool proper = !std::is_convertible_v<T*, basic_unique_func*> &&
+            !decltype(s_adoptable(std::declval<T*>()))::value &&
+            details::invocable_r<NE, Ret, const T&, Args&&...>;
 public:
     using base_type::base_type;
 
     template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
-    unique_func(T&& t)
+    basic_unique_func(T&& t)
     {
         base_type::template construct<signature_type, std::decay_t<T>>(this, std::forward<T>(t));
     }
 
     template <typename Allocator, typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
-    unique_func(std::allocator_arg_t, const Allocator& a, T&& t)
+    basic_unique_func(std::allocator_arg_t, const Allocator& a, T&& t)
     {
         base_type::template construct<signature_type, std::decay_t<T>>(this, std::allocator_arg, a, std::forward<T>(t));
     }
 
     template <typename T, typename... DTArgs, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
-    unique_func(std::in_place_type_t<T>, DTArgs&&... args)
+    basic_unique_func(std::in_place_type_t<T>, DTArgs&&... args)
     {
         base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
     }
 
-    Ret operator()(Args&& ...args) const
+    template <std::size_t OSize, std::size_t OAlign, bool ONE,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign> && (ONE || !NE), int> = 0>
+    basic_unique_func(basic_unique_func<Ret(Args...) const noexcept(ONE), OSize, OAlign, Policy>&& other) noexcept
     {
-        return base_type::call(std::forward<Args>(args)...);
+        base_type::adopt(std::move(other));
+    }
+
+    //constructs in place, without a temporary wrapper
+    template <typename T, typename... DTArgs, std::enable_if_t<proper<T>, int> = 0>
+    void emplace(DTArgs&&... args)
+    {
+        base_type::reset();
+        base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
+    }
+
+    Ret operator()(Args&& ...args) const noexcept(NE)
+    {
+        return base_type::template call<NE>(std::forward<Args>(args)...);
     }
 };
 
+namespace uf_details
+{
+
+template <typename Derived, std::size_t I, typename Sig>
+struct overload_call;
+
+template <typename Derived, std::size_t I, typename Ret, typename... Args, bool NE>
+struct overload_call<Derived, I, Ret(Args...) noexcept(NE)>
+{
+    Ret operator()(Args&& ...args) noexcept(NE)
+    {
+        return static_cast<Derived&>(*this).template call_at<I, NE>(std::forward<Args>(args)...);
+    }
+};
+
+template <typename Derived, std::size_t I, typename Ret, typename... Args, bool NE>
+struct overload_call<Derived, I, Ret(Args...) const noexcept(NE)>
+{
+    Ret operator()(Args&& ...args) const noexcept(NE)
+    {
+        return static_cast<const Derived&>(*this).template call_at<I, NE>(std::forward<Args>(args)...);
+    }
+};
+
+template <typename Derived, typename Indices, typename... Sigs>
+struct overload_calls;
+
+template <typename Derived, std::size_t... I, typename... Sigs>
+struct overload_calls<Derived, std::index_sequence<I...>, Sigs...> : overload_call<Derived, I, Sigs>...
+{
+    using overload_call<Derived, I, Sigs>::operator()...;
+};
+
+}
+
+//one storage and one table of invokers, each signature may be const or not
+template <typename... Sigs, std::size_t Size, std::size_t Align, typename Policy>
+class basic_unique_func<overload<Sigs...>, Size, Align, Policy> :
+        public uf_details::unique_func_base<overload<Sigs...>, Size, Align, Policy>,
+        public uf_details::overload_calls<basic_unique_func<overload<Sigs...>, Size, Align, Policy>,
+                                          std::index_sequence_for<Sigs...>, Sigs...>
+{
+    template <typename, std::size_t, typename>
+    friend struct uf_details::overload_call;
+
+    using signature_type = overload<Sigs...>;
+    using base_type = uf_details::unique_func_base<overload<Sigs...>, Size, Align, Policy>;
+
+    template <std::size_t OSize, std::size_t OAlign>
+    static std::bool_constant<base_type::template can_adopt<OSize, OAlign>>
+    s_adoptable(const uf_details::unique_func_base<overload<Sigs...>, OSize, OAlign, Policy>*);
+    static std::false_type s_adoptable(...);
+
+    template <typename T>
+    static constexpr bool proper = !std::is_convertible_v<T*, basic_unique_func*> &&
+            !decltype(s_adoptable(std::declval<T*>()))::value &&
+            (uf_details::invocable_as<T, Sigs>::value && ...);
+public:
+    using base_type::base_type;
+
+    template <typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_unique_func(T&& t)
+    {
+        base_type::template construct<signature_type, std::decay_t<T>>(this, std::forward<T>(t));
+    }
+
+    template <typename Allocator, typename T, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_unique_func(std::allocator_arg_t, const Allocator& a, T&& t)
+    {
+        base_type::template construct<signature_type, std::decay_t<T>>(this, std::allocator_arg, a, std::forward<T>(t));
+    }
+
+    template <typename T, typename... DTArgs, std::enable_if_t<proper<std::decay_t<T>>, int> = 0>
+    basic_unique_func(std::in_place_type_t<T>, DTArgs&&... args)
+    {
+        base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
+    }
+
+    template <std::size_t OSize, std::size_t OAlign,
+              std::enable_if_t<base_type::template can_adopt<OSize, OAlign>, int> = 0>
+    basic_unique_func(basic_unique_func<overload<Sigs...>, OSize, OAlign, Policy>&& other) noexcept
+    {
+        base_type::adopt(std::move(other));
+    }
+
+    template <typename T, typename... DTArgs, std::enable_if_t<proper<T>, int> = 0>
+    void emplace(DTArgs&&... args)
+    {
+        base_type::reset();
+        base_type::template construct<signature_type, T>(this, std::forward<DTArgs>(args)...);
+    }
+};
+
+namespace uf_details
+{
+
+template <typename Sig, std::size_t Size, std::size_t Align, typename Policy>
+const unique_func_base<Sig, Size, Align, Policy>& as_base(const unique_func_base<Sig, Size, Align, Policy>& f) noexcept
+{
+    return f;
+}
+
+template <typename T, typename... Ts, typename F, typename... A>
+decltype(auto) visit_as(F& f, A&& ...args)
+{
+    using result_type = decltype(f(std::forward<A>(args)...));
+    //a wrapper which can be called as const calls its target as const
+    constexpr bool as_const = std::is_invocable_v<const F&, A&&...>;
+    constexpr bool ne = noexcept(f(std::forward<A>(args)...));
+    if(auto p = as_base(f).template exact_target<as_const, ne, T>())
+    {
+        if constexpr(as_const)
+        {
+            return static_cast<result_type>(std::as_const(*p)(std::forward<A>(args)...));
+        }
+        else
+        {
+            return static_cast<result_type>((*p)(std::forward<A>(args)...));
+        }
+    }
+    if constexpr(sizeof...(Ts) != 0)
+    {
+        return visit_as<Ts...>(f, std::forward<A>(args)...);
+    }
+    else
+    {
+        return static_cast<result_type>(f(std::forward<A>(args)...));
+    }
+}
+
+}
+
+//calls the target directly if it is one of Ts, so the call can be inlined, and through the wrapper otherwise.
+//the expected types are tried in order, put the most common first. a target which came in
+//through another flavour of the signature, or an allocator, takes the indirect call
+template <typename... Ts, typename F, typename... A>
+decltype(auto) visit(F& f, A&& ...args)
+{
+    return uf_details::visit_as<Ts...>(f, std::forward<A>(args)...);
+}
+
 }
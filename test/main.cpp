@@ -1,7 +1,36 @@
+#include <vv6/atomic_shared_func.hpp>
+#include <vv6/copy_func.hpp>
+#include <vv6/func_batch.hpp>
+#include <vv6/func_pool.hpp>
+#include <vv6/func_queue.hpp>
+#include <vv6/func_reclaimer.hpp>
+#include <vv6/func_vector.hpp>
 #include <vv6/func_view.hpp>
+#include <vv6/inplace_func.hpp>
+#include <vv6/intrusive_func.hpp>
+#include <vv6/pipeline.hpp>
 #include <vv6/shared_func.hpp>
+#include <vv6/signal.hpp>
+#ifdef __cpp_impl_coroutine
+#include <vv6/task.hpp>
+#endif
+#include <vv6/thread_pool.hpp>
+#include <vv6/timer_wheel.hpp>
 #include <vv6/unique_func.hpp>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 #define BOOST_TEST_MODULE vv6 Test
 #include <boost/test/included/unit_test.hpp>
 
@@ -38,6 +67,17 @@ T& ref(T&& t)
     return t;
 }
 
+//a handle which is cheap to copy, though not trivially
+struct handle
+{
+    int id;
+    handle(int x) : id(x) {}
+    handle(const handle& other) : id(other.id) {}
+};
+
+template <>
+struct vv6::pass_by_value<handle> : std::true_type {};
+
 BOOST_AUTO_TEST_SUITE(test_func_view)
 
 static constexpr F a;
@@ -153,6 +193,108 @@ BOOST_AUTO_TEST_CASE(variance)
 }
 
 
+BOOST_AUTO_TEST_CASE(overloads)
+{
+    struct handler
+    {
+        std::size_t data = 0;
+        int error = 0;
+        int closed = 0;
+
+        void operator()(std::string_view s)
+        {
+            data += s.size();
+        }
+
+        void operator()(int e)
+        {
+            error = e;
+        }
+
+        void operator()()
+        {
+            ++closed;
+        }
+    } h;
+
+    using view = vv6::func_view<vv6::overload<void(std::string_view), void(int), void()>>;
+    static_assert(sizeof(view) == 2 * sizeof(void*));
+    static_assert(!std::is_constructible_v<view, handler&>);
+
+    view v(vv6::use_non_const, h);
+    v(std::string_view("abc"));
+    v(7);
+    v();
+    BOOST_TEST(h.data == 3u);
+    BOOST_TEST(h.error == 7);
+    BOOST_TEST(h.closed == 1);
+
+    struct G : F
+    {
+        using F::operator();
+
+        int operator()(int x, int y) const
+        {
+            return x * y;
+        }
+    } g;
+    vv6::func_view<vv6::overload<int(int, int), int(int)>> c(g);
+    BOOST_TEST(c(6, 7) == 42);
+    BOOST_TEST(c(10) == 52);
+}
+
+BOOST_AUTO_TEST_CASE(noexcept_signatures)
+{
+    auto nothrow = [](int x) noexcept { return x + 1; };
+    auto may_throw = [](int x) { return x + 2; };
+    using view = vv6::func_view<int(int) noexcept>;
+
+    static_assert(std::is_nothrow_invocable_v<view, int>);
+    static_assert(!std::is_nothrow_invocable_v<vv6::func_view<int(int)>, int>);
+    static_assert(std::is_constructible_v<view, decltype(nothrow)&>);
+    static_assert(!std::is_constructible_v<view, decltype(may_throw)&>);
+    static_assert(std::is_constructible_v<vv6::func_view<int(int)>, const view&>);
+    static_assert(!std::is_constructible_v<view, const vv6::func_view<int(int)>&>);
+
+    view v(nothrow);
+    BOOST_TEST(v(1) == 2);
+    vv6::func_view<int(int)> w(v);
+    BOOST_TEST(w(2) == 3);
+
+    int (*fp)(int) noexcept = +nothrow;
+    view p(fp);
+    BOOST_TEST(p(3) == 4);
+
+    auto both = [](auto... x) noexcept { return (0 + ... + x); };
+    auto sum = [](auto... x) { return (0 + ... + x); };
+    using overload_view = vv6::func_view<vv6::overload<int(int) noexcept, int()>>;
+    static_assert(std::is_constructible_v<overload_view, decltype(both)&>);
+    static_assert(!std::is_constructible_v<overload_view, decltype(sum)&>);
+    overload_view o(both);
+    static_assert(noexcept(o(1)));
+    static_assert(!noexcept(o()));
+    BOOST_TEST(o(5) == 5);
+    BOOST_TEST(o() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(pass_by_value)
+{
+    static_assert(vv6::pass_by_value<int>::value);
+    static_assert(vv6::pass_by_value<void*>::value);
+    static_assert(!vv6::pass_by_value<int&>::value);
+    static_assert(!vv6::pass_by_value<std::string>::value);
+    static_assert(vv6::pass_by_value<std::string_view>::value == (vv6::pass_by_value_size >= sizeof(std::string_view)));
+    static_assert(vv6::pass_by_value<handle>::value);
+
+    auto size = [](std::string_view s) { return s.size(); };
+    vv6::func_view<std::size_t(std::string_view)> f(size);
+    BOOST_TEST(f(std::string_view("abc")) == 3u);
+
+    auto id = [](handle h) { return h.id; };
+    vv6::func_view<int(handle)> g(id);
+    BOOST_TEST(g(handle(42)) == 42);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -234,6 +376,279 @@ BOOST_AUTO_TEST_CASE(bool_conv)
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(test_atomic_shared_func)
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    vv6::atomic_shared_func<int(int)> a;
+    BOOST_TEST(!a);
+    BOOST_TEST(!a.load());
+
+    a.store(vv6::make_shared_func<int(int)>(F()));
+    BOOST_TEST(bool(a));
+    BOOST_TEST(a(10) == 52);
+
+    auto old = a.exchange(vv6::shared_func<int(int)>(vv6::use_non_const, std::make_shared<F>()));
+    BOOST_TEST(old(10) == 52);
+    BOOST_TEST(a(10) == 32);
+    BOOST_TEST(a.load()(10) == 32);
+
+    a.store({});
+    BOOST_TEST(!a);
+    BOOST_TEST(!a.exchange(vv6::shared_func<int(int)>(F::f)));
+    BOOST_TEST(a(0) == 42);
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+    //each handler checks that it is still alive when it is called
+    struct handler
+    {
+        std::shared_ptr<int> m_alive = std::make_shared<int>(1);
+        int m_value;
+
+        explicit handler(int value) : m_value(value) {}
+
+        int operator()(int x) const
+        {
+            return *m_alive * m_value + x;
+        }
+    };
+
+    vv6::atomic_shared_func<int(int)> a(vv6::make_shared_func<int(int)>(handler(0)));
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> readers;
+    for(int t = 0; t < 3; ++t)
+    {
+        readers.emplace_back([&, t]
+        {
+            int last = 0;
+            while(!done.load(std::memory_order_relaxed))
+            {
+                int v = t % 2 ? a(0) : a.load()(0);
+                //values only grow, one writer publishes them in order
+                if(v < last)
+                {
+                    ++bad;
+                }
+                last = v;
+            }
+        });
+    }
+    for(int i = 1; i <= 2000; ++i)
+    {
+        a.store(vv6::make_shared_func<int(int)>(handler(i)));
+    }
+    done = true;
+    for(auto& t : readers)
+    {
+        t.join();
+    }
+    BOOST_TEST(bad.load() == 0);
+    BOOST_TEST(a(0) == 2000);
+}
+
+BOOST_AUTO_TEST_CASE(grace_period)
+{
+    //counts its copies, a call may wait until it is released
+    struct handler
+    {
+        std::atomic<int>* m_alive;
+        std::promise<void>* m_entered;
+        std::shared_future<void> m_release;
+
+        handler(std::atomic<int>* alive, std::promise<void>* entered, std::shared_future<void> release) :
+            m_alive(alive), m_entered(entered), m_release(std::move(release))
+        {
+            ++*m_alive;
+        }
+
+        handler(const handler& other) :
+            m_alive(other.m_alive), m_entered(other.m_entered), m_release(other.m_release)
+        {
+            ++*m_alive;
+        }
+
+        ~handler()
+        {
+            --*m_alive;
+        }
+
+        void operator()() const
+        {
+            m_entered->set_value();
+            m_release.wait();
+        }
+    };
+
+    std::atomic<int> alive{0};
+    std::promise<void> entered1, entered2, release1, release2;
+    vv6::atomic_shared_func<void()> a(vv6::make_shared_func<void()>(handler(&alive, &entered1, release1.get_future())));
+
+    std::thread t1([&] { a(); });
+    entered1.get_future().wait();
+    a.store(vv6::make_shared_func<void()>(handler(&alive, &entered2, release2.get_future())));
+    std::thread t2([&] { a(); });
+    entered2.get_future().wait();
+    BOOST_TEST(alive.load() == 2);
+
+    //the readers overlap, the first one is freed once its last caller is gone although the second one still runs
+    release1.set_value();
+    t1.join();
+    a.store(vv6::make_shared_func<void()>(handler(&alive, nullptr, {})));
+    BOOST_TEST(alive.load() == 2);
+
+    release2.set_value();
+    t2.join();
+    a.store({});
+    BOOST_TEST(alive.load() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_intrusive_func)
+
+static_assert (sizeof(vv6::intrusive_func<int(int)>) == 2 * sizeof(void*));
+static_assert (std::is_nothrow_copy_constructible_v<vv6::intrusive_func<int(int)>>);
+static_assert (std::is_nothrow_move_constructible_v<vv6::intrusive_func<int(int)>>);
+static_assert (std::is_nothrow_copy_assignable_v<vv6::intrusive_func<int(int), vv6::local_count>>);
+static_assert (std::is_nothrow_move_assignable_v<vv6::intrusive_func<int(int), vv6::local_count>>);
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    auto f1 = vv6::make_intrusive_func<int(int)>(F());
+    BOOST_TEST(f1(10) == 52);
+    BOOST_TEST(f1.use_count() == 1);
+
+    auto f2 = vv6::make_intrusive_func<int(int)>(vv6::use_non_const, F());
+    BOOST_TEST(f2(10) == 32);
+
+    auto f3 = vv6::make_intrusive_func([](int x) {return 42 - x;});
+    BOOST_TEST(f3(10) == 32);
+
+    auto f4 = vv6::make_intrusive_func<int(int), vv6::local_count>(F::f);
+    BOOST_TEST(f4(0) == 42);
+
+    vv6::intrusive_func<int(int)> f5(f1), f6;
+    BOOST_TEST(f1.use_count() == 2);
+    BOOST_TEST(f5(10) == 52);
+    BOOST_TEST(f5.view()(0) == 42);
+
+    f6 = std::move(f5);
+    BOOST_TEST(!f5);
+    BOOST_TEST(f6(0) == 42);
+    BOOST_TEST(f1.use_count() == 2);
+
+    f6 = f2;
+    BOOST_TEST(f1.use_count() == 1);
+    BOOST_TEST(f2.use_count() == 2);
+    BOOST_TEST(f6(10) == 32);
+}
+
+BOOST_AUTO_TEST_CASE(lifetime)
+{
+    int lived = 0;
+    struct A
+    {
+        int *m_a;
+        A(int *a) : m_a(a)
+        {
+            ++(*m_a);
+        }
+
+        A(const A&) = delete;
+
+        ~A()
+        {
+            --(*m_a);
+        }
+
+        int operator()(int x) const
+        {
+            return x;
+        }
+    };
+
+    {
+        vv6::intrusive_func<int(int), vv6::local_count> f(std::in_place_type<A>, &lived);
+        BOOST_TEST(lived == 1);
+        {
+            auto g = f;
+            BOOST_TEST(g(1) == 1);
+        }
+        BOOST_TEST(lived == 1);
+    }
+    BOOST_TEST(lived == 0);
+}
+
+BOOST_AUTO_TEST_CASE(local)
+{
+    static_assert (!std::is_convertible_v<vv6::local_shared_func<int(int)>&&, vv6::intrusive_func<int(int)>>);
+    static_assert (std::is_constructible_v<vv6::intrusive_func<int(int)>, vv6::local_shared_func<int(int)>&&>);
+    static_assert (!std::is_constructible_v<vv6::intrusive_func<int(int)>, const vv6::local_shared_func<int(int)>&>);
+
+    auto f1 = vv6::make_local_shared_func<int(int)>(F());
+    BOOST_TEST(f1(10) == 52);
+
+    auto f2 = vv6::make_local_shared_func<int(int)>(vv6::use_non_const, F());
+    BOOST_TEST(f2(10) == 32);
+    BOOST_TEST(f2.view()(10) == 32);
+
+    auto f3 = vv6::make_local_shared_func([](int x) {return 42 - x;});
+    static_assert (std::is_same_v<decltype(f3), vv6::local_shared_func<int(int)>>);
+    BOOST_TEST(f3(10) == 32);
+
+    auto f4 = f1;
+    BOOST_CHECK_THROW(vv6::intrusive_func<int(int)>{std::move(f1)}, std::invalid_argument);
+    BOOST_TEST(bool(f1));
+
+    f4 = {};
+    vv6::intrusive_func<int(int)> f5(std::move(f1));
+    BOOST_TEST(!f1);
+    BOOST_TEST(f5(10) == 52);
+    BOOST_TEST(f5.use_count() == 1);
+
+    vv6::local_shared_func<int(int)> f6(std::move(f5));
+    BOOST_TEST(!f5);
+    BOOST_TEST(f6(10) == 52);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//counts the calls of its move constructor and destructor
+struct relocated : F
+{
+    static inline int moves = 0;
+    static inline int destroyed = 0;
+    std::unique_ptr<int> p = std::make_unique<int>(1);
+
+    relocated() = default;
+
+    relocated(relocated&& other) noexcept :
+        F(other), p(std::move(other.p))
+    {
+        ++moves;
+    }
+
+    ~relocated()
+    {
+        ++destroyed;
+    }
+};
+
+template <>
+struct vv6::is_trivially_relocatable<relocated> : std::true_type {};
+
+//a lambda with the same capture, opted in through the type the function returns
+inline auto make_relocated_lambda()
+{
+    return [r = relocated()](int x) { return r(x) + 1; };
+}
+
+template <>
+struct vv6::is_trivially_relocatable<decltype(make_relocated_lambda())> : std::true_type {};
+
 BOOST_AUTO_TEST_SUITE(test_unique_func)
 
 static_assert (std::is_nothrow_move_constructible_v<vv6::unique_func<int(int)>>);
@@ -368,87 +783,1834 @@ BOOST_AUTO_TEST_CASE(test4)
     BOOST_TEST(f2(10) == 10);
 }
 
-BOOST_AUTO_TEST_CASE(test_void)
+BOOST_AUTO_TEST_CASE(capacity)
 {
-    vv6::unique_func<void(int)> f(a);
-    BOOST_TEST(bool(f));
-}
+    struct G : F
+    {
+        char pad[2 * sizeof(std::max_align_t)] = {};
+    } g;
 
-BOOST_AUTO_TEST_CASE(upcast)
-{
-    vv6::unique_func<int(int) const> f(a);
-    BOOST_TEST(f(10) == 52);
+    constexpr std::size_t big = 4 * sizeof(std::max_align_t);
+    using big_storage = vv6::uf_details::basic_storage<big, alignof(std::max_align_t)>;
+    static_assert(!vv6::uf_details::is_inplace<G>);
+    static_assert(vv6::uf_details::is_inplace<G, big_storage>);
 
-    vv6::unique_func<int(int)> g(std::move(f));
-    BOOST_TEST(!f);
-    BOOST_TEST(g(10) == 52);
+    allocated = deallocated = 0;
+    {
+        // trivially copyable but too large, must not be copied into the storage
+        vv6::unique_func<int(int) const> f1(std::allocator_arg, allocator<void>(), g);
+        BOOST_TEST(f1(0) == 42);
+        BOOST_TEST(allocated == sizeof(G));
+
+        vv6::basic_unique_func<int(int) const, big> f2(std::allocator_arg, allocator<void>(), g);
+        BOOST_TEST(f2(0) == 42);
+        BOOST_TEST(allocated == sizeof(G));
+
+        // external objects only hand over the pointer
+        vv6::basic_unique_func<int(int) const, big> f3(std::move(f1));
+        BOOST_TEST(!f1);
+        BOOST_TEST(f3(0) == 42);
+
+        vv6::basic_unique_func<int(int), 2 * big> f4(std::move(f2));
+        BOOST_TEST(!f2);
+        BOOST_TEST(f4(0) == 42);
+        BOOST_TEST(allocated == sizeof(G));
+
+        vv6::unique_func<int(int) const> f5(a);
+        vv6::basic_unique_func<int(int), big> f6(std::move(f5));
+        BOOST_TEST(!f5);
+        BOOST_TEST(f6(10) == 52);
+    }
+    BOOST_TEST(allocated == deallocated);
+
+    static_assert(std::is_constructible_v<vv6::basic_unique_func<int(int), big>, vv6::unique_func<int(int) const>&&>);
+    static_assert(std::is_constructible_v<vv6::basic_unique_func<int(int) const, big>, vv6::unique_func<int(int) const>&&>);
+    static_assert(!std::is_constructible_v<vv6::basic_unique_func<int(int) const, big>, vv6::unique_func<int(int)>&&>);
+    static_assert(sizeof(vv6::basic_unique_func<int(int), big>) == big + 2 * sizeof(void*));
 }
 
-BOOST_AUTO_TEST_CASE(variance)
+BOOST_AUTO_TEST_CASE(vtable)
 {
-    struct A {};
-    struct B : A {};
-    struct C : B {};
+    using inline_func = vv6::basic_unique_func<int(int), 48, alignof(void*)>;
+    using table_func = vv6::basic_unique_func<int(int), 48, alignof(void*), vv6::vtable_policy>;
+    static_assert(sizeof(inline_func) == 48 + 2 * sizeof(void*));
+    static_assert(sizeof(table_func) == 48 + sizeof(void*));
 
-    struct F1
+    auto p = std::make_unique<int>(10);
+    struct G : F
     {
-        B operator()(B x) const
-        {
-            return x;
-        }
-    } a;
+        char pad[64] = {};
+    };
 
+    table_func f1(a), f2([p = std::move(p)](int x) { return x + *p; }), f3(G{});
+    BOOST_TEST(f1(10) == 32);
+    BOOST_TEST(f2(10) == 20);
+    BOOST_TEST(f3(10) == 32);
 
-    static_assert (std::is_constructible_v<vv6::unique_func<A(B)>, F1&>);
-    static_assert (std::is_constructible_v<vv6::unique_func<B(C)>, F1&>);
+    vv6::basic_unique_func<int(int), 64, alignof(void*), vv6::vtable_policy> f4(std::move(f2));
+    BOOST_TEST(!f2);
+    BOOST_TEST(f4(1) == 11);
+    f4 = std::move(f3);
+    BOOST_TEST(f4(1) == 41);
+    f4.reset();
+    BOOST_TEST(!f4);
 
-    static_assert (!std::is_constructible_v<vv6::unique_func<C(B)>, F1&>);
-    static_assert (!std::is_constructible_v<vv6::unique_func<B(A)>, F1&>);
+    vv6::basic_copy_func<int(int) const, vv6::default_capacity, vv6::default_alignment, vv6::vtable_policy> c1(a);
+    auto c2 = c1;
+    BOOST_TEST(c1(0) == 42);
+    BOOST_TEST(c2(0) == 42);
 }
 
-BOOST_AUTO_TEST_CASE(move_assign)
+struct counting_resource : std::pmr::memory_resource
+{
+    std::size_t allocated = 0;
+    std::size_t deallocated = 0;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        allocated += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        deallocated += bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(memory_resource)
 {
     int lived = 0;
-    struct A
+    struct G : F
     {
-        int *m_a;
-        A(int *a = nullptr) : m_a(a)
+        int* m_lived;
+        char pad[2 * sizeof(std::max_align_t)] = {};
+
+        G(int* lived) : m_lived(lived)
         {
-            ++(*m_a);
+            ++*m_lived;
         }
 
-        A(A&& other) noexcept : m_a(other.m_a)
+        G(const G& other) : F(other), m_lived(other.m_lived)
         {
-            other.m_a = nullptr;
+            ++*m_lived;
         }
 
-        A& operator=(A&& other) noexcept
+        ~G()
         {
-            A tmp(std::move(other));
-            std::swap(tmp.m_a, m_a);
-            return *this;
+            --*m_lived;
         }
+    };
 
-        ~A()
+    counting_resource r;
+    {
+        vv6::unique_func<int(int) const> f1(std::allocator_arg, &r, G(&lived));
+        BOOST_TEST(f1(0) == 42);
+        BOOST_TEST(r.allocated == sizeof(void*) + sizeof(G));
+
+        vv6::unique_func<int(int) const> f2(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&r), G(&lived));
+        BOOST_TEST(f2(0) == 42);
+
+        vv6::copy_func<int(int)> f3(std::allocator_arg, &r, G(&lived));
+        auto f4 = f3;
+        BOOST_TEST(f4(0) == 42);
+        BOOST_TEST(r.allocated == 4 * (sizeof(void*) + sizeof(G)));
+        BOOST_TEST(lived == 4);
+    }
+    BOOST_TEST(lived == 0);
+    BOOST_TEST(r.deallocated == r.allocated);
+
+    {
+        //counts what it is asked to give back, the memory goes when the arena does
+        struct counting_arena : std::pmr::memory_resource
         {
-            if(m_a)
+            std::pmr::monotonic_buffer_resource m_arena;
+            std::size_t deallocations = 0;
+
+            explicit counting_arena(std::pmr::memory_resource* upstream) : m_arena(upstream) {}
+
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override
             {
-                --(*m_a);
+                return m_arena.allocate(bytes, alignment);
             }
-        }
 
-        void operator()()
+            void do_deallocate(void*, std::size_t, std::size_t) override
+            {
+                ++deallocations;
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+            {
+                return this == &other;
+            }
+        } arena(&r);
+
         {
+            vv6::unique_func<int(int)> f(std::allocator_arg, &arena, G(&lived));
+            BOOST_TEST(f(0) == 42);
+        }
+        BOOST_TEST(lived == 0);
+        BOOST_TEST(arena.deallocations == 1u);
 
+        //a releasable resource is released as a whole, the callables are still destroyed
+        {
+            vv6::unique_func<int(int)> f(std::allocator_arg, vv6::releasable_resource(&arena), G(&lived));
+            BOOST_TEST(f(0) == 42);
+            BOOST_TEST(lived == 1);
+            vv6::copy_func<int(int)> f2(std::allocator_arg, vv6::releasable_resource(&arena), G(&lived));
+            auto f3 = f2;
+            BOOST_TEST(lived == 3);
         }
+        BOOST_TEST(lived == 0);
+        BOOST_TEST(arena.deallocations == 1u);
+    }
+    BOOST_TEST(r.deallocated == r.allocated);
+}
+
+BOOST_AUTO_TEST_CASE(pool)
+{
+    using pooled_func = vv6::basic_unique_func<int(int) const, vv6::default_capacity, vv6::default_alignment,
+                                               vv6::pool_policy>;
+    struct G : F
+    {
+        char pad[2 * sizeof(std::max_align_t)] = {};
+    };
+    struct H : F
+    {
+        char pad[4096] = {};
     };
 
+    auto before = vv6::func_pool::stats();
     {
-        vv6::unique_func<void()> a;
-        vv6::unique_func<void()> func{A(&lived)};
-        func = std::move(a);
+        pooled_func f1(G{});
+        BOOST_TEST(f1(0) == 42);
     }
-    BOOST_CHECK(lived == 0);
-}
+    for(int i = 0; i < 10; ++i)
+    {
+        pooled_func f2(G{});
+        auto f3 = std::move(f2);
+        BOOST_TEST(f3(1) == 43);
+    }
+    auto after = vv6::func_pool::stats();
+    BOOST_TEST(after.hits - before.hits >= 10u);
 
-BOOST_AUTO_TEST_SUITE_END()
+    //too large for the size classes
+    pooled_func f4(H{});
+    BOOST_TEST(f4(0) == 42);
+    BOOST_TEST(vv6::func_pool::stats().misses > after.misses);
+
+    vv6::basic_copy_func<int(int) const, vv6::default_capacity, vv6::default_alignment, vv6::pool_policy> c1(G{});
+    auto c2 = c1;
+    BOOST_TEST(c2(0) == 42);
+
+    //allocated here, freed by the other threads
+    std::vector<pooled_func> funcs;
+    for(int i = 0; i < 1000; ++i)
+    {
+        funcs.emplace_back([i, pad = G{}](int x) { return x + i + pad.a; });
+    }
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&funcs, t]
+        {
+            for(std::size_t i = t; i < funcs.size(); i += 4)
+            {
+                funcs[i].reset();
+                pooled_func f([pad = G{}](int x) { return x + pad.a; });
+                f(0);
+            }
+        });
+    }
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+    auto last = vv6::func_pool::stats();
+    for(int i = 0; i < 1000; ++i)
+    {
+        funcs[i] = pooled_func(G{});
+    }
+    BOOST_TEST(vv6::func_pool::stats().hits - last.hits >= 900u);
+}
+
+BOOST_AUTO_TEST_CASE(relocatable)
+{
+    static_assert(vv6::is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(vv6::is_trivially_relocatable_v<std::shared_ptr<int>>);
+    static_assert(vv6::is_trivially_relocatable_v<std::pair<int, std::unique_ptr<int>>>);
+    static_assert(!vv6::is_trivially_relocatable_v<std::unique_ptr<int, void(*)(int*)>>);
+    static_assert(!vv6::is_trivially_relocatable_v<std::pair<int, std::string_view&>>);
+
+    relocated::moves = 0;
+    relocated::destroyed = 0;
+    {
+        vv6::unique_func<int(int) const> f(std::in_place_type<relocated>);
+        BOOST_TEST(relocated::moves == 0);
+        auto g = std::move(f);
+        f = std::move(g);
+        vv6::unique_func<int(int) const> h;
+        h = std::move(f);
+        BOOST_TEST(h(1) == 43);
+        BOOST_TEST(relocated::moves == 0);
+        BOOST_TEST(relocated::destroyed == 0);
+
+        std::vector<vv6::unique_func<int(int) const>> v;
+        for(int i = 0; i < 100; ++i)
+        {
+            v.emplace_back(std::in_place_type<relocated>);
+        }
+        BOOST_TEST(v[0](0) == 42);
+        BOOST_TEST(relocated::moves == 0);
+
+        //the vtable carries the same flag
+        vv6::basic_unique_func<int(int) const, vv6::default_capacity, vv6::default_alignment,
+                               vv6::vtable_policy> t1(std::in_place_type<relocated>);
+        auto t2 = std::move(t1);
+        BOOST_TEST(t2(0) == 42);
+        BOOST_TEST(relocated::moves == 0);
+    }
+    BOOST_TEST(relocated::destroyed == 102);
+
+    //a lambda is only covered by default when its captures are trivially copyable
+    int k = 1;
+    auto by_copy = [k, p = &k](int x) { return x + k + *p; };
+    auto owning = [r = relocated()](int x) { return r(x); };
+    static_assert(vv6::is_trivially_relocatable_v<decltype(by_copy)>);
+    static_assert(!vv6::is_trivially_relocatable_v<decltype(owning)>);
+    static_assert(vv6::is_trivially_relocatable_v<decltype(make_relocated_lambda())>);
+
+    relocated::moves = 0;
+    {
+        vv6::unique_func<int(int) const> f(std::move(owning));
+        auto before = relocated::moves;
+        auto g = std::move(f);
+        BOOST_TEST(g(0) == 42);
+        BOOST_TEST(relocated::moves == before + 1);
+
+        vv6::unique_func<int(int) const> h(make_relocated_lambda());
+        before = relocated::moves;
+        auto i = std::move(h);
+        BOOST_TEST(i(0) == 43);
+        BOOST_TEST(relocated::moves == before);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(deferred_destruction)
+{
+    using func = vv6::basic_unique_func<int(int) const, vv6::default_capacity, vv6::default_alignment,
+                                        vv6::deferred_policy>;
+    auto counter = std::make_shared<int>(0);
+    vv6::func_reclaimer::drain();
+    {
+        func f1([counter](int x) { return x + 1; });
+        func f2([counter, payload = std::array<long, 16>{}](int x) { return x + int(payload[0]); });
+        func f3([s = std::string(64, 'x')](int x) { return x + int(s.size()); });
+        relocated::destroyed = 0;
+        func f4(std::in_place_type<relocated>);
+        BOOST_TEST(counter.use_count() == 3);
+        BOOST_TEST(f3(0) == 64);
+
+        //assigning retires the old one as well
+        f1 = func([](int x) { return x; });
+        BOOST_TEST(vv6::func_reclaimer::pending() == 1u);
+        BOOST_TEST(counter.use_count() == 3);
+    }
+    //the last one of f1 needs no destructor, so it was not retired
+    BOOST_TEST(vv6::func_reclaimer::pending() == 4u);
+    BOOST_TEST(counter.use_count() == 3);
+    BOOST_TEST(relocated::destroyed == 0);
+    BOOST_TEST(vv6::func_reclaimer::drain() == 4u);
+    BOOST_TEST(vv6::func_reclaimer::pending() == 0u);
+    BOOST_TEST(counter.use_count() == 1);
+    BOOST_TEST(relocated::destroyed == 1);
+
+    //enough to fill several chunks, destroyed by another thread
+    {
+        std::vector<func> v;
+        for(int i = 0; i < 1000; ++i)
+        {
+            v.emplace_back([counter, i](int x) { return x + i; });
+        }
+    }
+    BOOST_TEST(counter.use_count() == 1001);
+    vv6::func_reclaimer::flush();
+    BOOST_TEST(vv6::func_reclaimer::pending() == 0u);
+    std::size_t collected = 0;
+    std::thread t([&]() { collected = vv6::func_reclaimer::collect(); });
+    t.join();
+    BOOST_TEST(collected == 1000u);
+    BOOST_TEST(counter.use_count() == 1);
+
+    //a thread destroys what it did not drain when it exits
+    std::thread([counter]() { func f([counter](int x) { return x; }); }).join();
+    BOOST_TEST(counter.use_count() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(instrumentation)
+{
+    struct counted_policy : vv6::default_policy
+    {
+        using instrumentation = vv6::counting_instrumentation<true>;
+    };
+    using counted_func = vv6::basic_unique_func<long(short) const, vv6::default_capacity, vv6::default_alignment,
+                                                counted_policy>;
+    struct G
+    {
+        char pad[100] = {};
+
+        long operator()(short x) const
+        {
+            return x + pad[0];
+        }
+    };
+
+    static_assert(sizeof(counted_func) == sizeof(vv6::unique_func<long(short) const>));
+    vv6::reset_instrumentation_stats<long(short)>();
+    {
+        counted_func f1([](short x) { return long(x); });
+        counted_func f2(G{});
+        counted_func f3(std::allocator_arg, std::allocator<char>(), G{});
+        auto f4 = std::move(f1);
+        f1 = std::move(f4);
+        BOOST_TEST(f1(1) + f2(2) + f3(3) == 6);
+    }
+    auto stats = vv6::instrumentation_stats<long(short)>();
+    BOOST_TEST(stats.inline_constructs == 1u);
+    BOOST_TEST(stats.external_constructs == 1u);
+    BOOST_TEST(stats.allocator_constructs == 1u);
+    BOOST_TEST(stats.moves == 1u);
+    BOOST_TEST(stats.move_assigns == 1u);
+    BOOST_TEST(stats.calls == 3u);
+    BOOST_TEST(stats.sizes[0] == 1u);
+    BOOST_TEST(stats.sizes[4] == 2u);
+
+    //counted by a thread which is gone by now
+    std::thread([]
+    {
+        counted_func f([](short x) { return long(x); });
+        for(short i = 0; i < 10; ++i)
+        {
+            f(short(i));
+        }
+    }).join();
+    BOOST_TEST(vv6::instrumentation_stats<long(short)>().calls == 13u);
+
+    //the default policy counts nothing
+    vv6::unique_func<long(short) const> f5([](short x) { return long(x); });
+    f5(1);
+    BOOST_TEST(vv6::instrumentation_stats<long(short)>().calls == 13u);
+}
+
+BOOST_AUTO_TEST_CASE(target)
+{
+    struct G : F
+    {
+        char pad[2 * sizeof(std::max_align_t)] = {};
+    };
+    struct H
+    {
+        int operator()(int x)
+        {
+            return -x;
+        }
+    };
+
+    vv6::unique_func<int(int) const> f1(F(1));
+    BOOST_TEST(f1.target<F>()->a == 1);
+    BOOST_TEST(!f1.target<G>());
+    BOOST_TEST(!vv6::unique_func<int(int)>().target<F>());
+
+    //adopted from a const wrapper
+    vv6::unique_func<int(int)> f2(std::move(f1));
+    BOOST_TEST(f2.target<F>()->a == 1);
+    f2.target<F>()->a = 2;
+    BOOST_TEST(f2(0) == 2);
+
+    auto l = [](int x) noexcept { return x; };
+    vv6::unique_func<int(int) noexcept> f0(l);
+    BOOST_TEST(f0.target<decltype(l)>());
+
+    vv6::unique_func<int(int)> f3(G{});
+    BOOST_TEST(f3.target<G>()->a == 42);
+    BOOST_TEST(!f3.target<F>());
+
+    vv6::basic_unique_func<int(int), 128> f4(std::move(f3));
+    BOOST_TEST(f4.target<G>()->a == 42);
+
+    counting_resource r;
+    vv6::unique_func<int(int)> f5(std::allocator_arg, &r, G{});
+    BOOST_TEST(f5.target<G>()->a == 42);
+
+    vv6::basic_unique_func<int(int), vv6::default_capacity, vv6::default_alignment, vv6::pool_policy> f6(G{});
+    BOOST_TEST(f6.target<G>()->a == 42);
+
+    vv6::unique_func<int(int)> f7(&F::f);
+    BOOST_TEST(*f7.target<int(*)(int)>() == &F::f);
+
+    vv6::unique_func<vv6::overload<int(int), int(int) const>> f8(F(5));
+    BOOST_TEST(f8.target<F>()->a == 5);
+    BOOST_TEST(!f8.target<G>());
+
+    vv6::copy_func<int(int)> c1(G{});
+    BOOST_TEST(c1.target<G>()->a == 42);
+
+    //direct calls for the expected types, the others through the wrapper
+    std::vector<vv6::unique_func<int(int)>> funcs;
+    funcs.emplace_back(F(1));
+    funcs.emplace_back(G{});
+    funcs.emplace_back(H{});
+    funcs.emplace_back(&F::f);
+    int sum = 0;
+    for(auto& f : funcs)
+    {
+        sum += vv6::visit<F, H>(f, 10);
+    }
+    BOOST_TEST(sum == -9 + 32 - 10 + 52);
+
+    const vv6::unique_func<int(int) const> f9(F(3));
+    BOOST_TEST((vv6::visit<G, F>(f9, 1) == 4));
+
+    //the vtable layout keeps no invoker of its own
+    using table_func = vv6::basic_unique_func<int(int), 64, 16, vv6::vtable_policy>;
+    BOOST_TEST(!table_func().target<F>());
+    table_func f10;
+    BOOST_TEST(!f10.target<G>());
+    f10 = F(4);
+    BOOST_TEST(f10.target<F>()->a == 4);
+    BOOST_TEST((vv6::visit<G, F>(f10, 1) == 3));
+    BOOST_TEST((vv6::visit<G, H>(f10, 1) == 3));
+}
+
+BOOST_AUTO_TEST_CASE(test_void)
+{
+    vv6::unique_func<void(int)> f(a);
+    BOOST_TEST(bool(f));
+}
+
+BOOST_AUTO_TEST_CASE(upcast)
+{
+    vv6::unique_func<int(int) const> f(a);
+    BOOST_TEST(f(10) == 52);
+
+    vv6::unique_func<int(int)> g(std::move(f));
+    BOOST_TEST(!f);
+    BOOST_TEST(g(10) == 52);
+}
+
+BOOST_AUTO_TEST_CASE(variance)
+{
+    struct A {};
+    struct B : A {};
+    struct C : B {};
+
+    struct F1
+    {
+        B operator()(B x) const
+        {
+            return x;
+        }
+    } a;
+
+
+    static_assert (std::is_constructible_v<vv6::unique_func<A(B)>, F1&>);
+    static_assert (std::is_constructible_v<vv6::unique_func<B(C)>, F1&>);
+
+    static_assert (!std::is_constructible_v<vv6::unique_func<C(B)>, F1&>);
+    static_assert (!std::is_constructible_v<vv6::unique_func<B(A)>, F1&>);
+}
+
+BOOST_AUTO_TEST_CASE(move_assign)
+{
+    int lived = 0;
+    struct A
+    {
+        int *m_a;
+        A(int *a = nullptr) : m_a(a)
+        {
+            ++(*m_a);
+        }
+
+        A(A&& other) noexcept : m_a(other.m_a)
+        {
+            other.m_a = nullptr;
+        }
+
+        A& operator=(A&& other) noexcept
+        {
+            A tmp(std::move(other));
+            std::swap(tmp.m_a, m_a);
+            return *this;
+        }
+
+        ~A()
+        {
+            if(m_a)
+            {
+                --(*m_a);
+            }
+        }
+
+        void operator()()
+        {
+
+        }
+    };
+
+    {
+        vv6::unique_func<void()> a;
+        vv6::unique_func<void()> func{A(&lived)};
+        func = std::move(a);
+    }
+    BOOST_CHECK(lived == 0);
+}
+
+BOOST_AUTO_TEST_CASE(overloads)
+{
+    struct connection
+    {
+        std::unique_ptr<std::string> m_buffer = std::make_unique<std::string>();
+        int m_error = 0;
+
+        void operator()(std::string_view s)
+        {
+            *m_buffer += s;
+        }
+
+        void operator()(int e)
+        {
+            m_error = e;
+        }
+
+        std::size_t operator()() const
+        {
+            return m_buffer->size() + m_error;
+        }
+    };
+
+    using handler = vv6::unique_func<vv6::overload<void(std::string_view), void(int), std::size_t() const>>;
+    static_assert(sizeof(handler) == sizeof(vv6::unique_func<void()>));
+    static_assert(!std::is_copy_constructible_v<handler>);
+
+    handler h(connection{});
+    h(std::string_view("abc"));
+    h(2);
+    BOOST_TEST(std::as_const(h)() == 5u);
+
+    vv6::basic_unique_func<vv6::overload<void(std::string_view), void(int), std::size_t() const>, 128> g(std::move(h));
+    BOOST_TEST(!h);
+    g(std::string_view("de"));
+    BOOST_TEST(std::as_const(g)() == 7u);
+
+    using table_handler = vv6::basic_unique_func<vv6::overload<void(int), int() const>,
+            vv6::default_capacity, vv6::default_alignment, vv6::vtable_policy>;
+    struct counter
+    {
+        int n = 0;
+        char pad[128] = {};
+
+        void operator()(int x)
+        {
+            n += x;
+        }
+
+        int operator()() const
+        {
+            return n;
+        }
+    };
+    table_handler t(counter{});
+    t(3);
+    t(4);
+    BOOST_TEST(std::as_const(t)() == 7);
+}
+
+BOOST_AUTO_TEST_CASE(noexcept_signatures)
+{
+    auto p = std::make_unique<int>(1);
+    auto nothrow = [p = std::move(p)](int x) noexcept { return x + *p; };
+    auto may_throw = [](int x) { return x + 2; };
+
+    using nothrow_func = vv6::unique_func<int(int) const noexcept>;
+    static_assert(std::is_nothrow_invocable_v<const nothrow_func&, int>);
+    static_assert(std::is_nothrow_invocable_v<vv6::unique_func<int(int) noexcept>&, int>);
+    static_assert(!std::is_constructible_v<nothrow_func, decltype(may_throw)>);
+
+    static_assert(std::is_constructible_v<vv6::unique_func<int(int)>, nothrow_func&&>);
+    static_assert(std::is_constructible_v<vv6::unique_func<int(int) const>, nothrow_func&&>);
+    static_assert(std::is_constructible_v<vv6::unique_func<int(int) noexcept>, nothrow_func&&>);
+    static_assert(!std::is_constructible_v<nothrow_func, vv6::unique_func<int(int) const>&&>);
+    static_assert(!std::is_constructible_v<vv6::unique_func<int(int) noexcept>, vv6::unique_func<int(int)>&&>);
+    static_assert(!std::is_constructible_v<nothrow_func, vv6::unique_func<int(int) noexcept>&&>);
+
+    nothrow_func f(std::move(nothrow));
+    BOOST_TEST(f(1) == 2);
+    vv6::unique_func<int(int) noexcept> g(std::move(f));
+    BOOST_TEST(!f);
+    BOOST_TEST(g(2) == 3);
+    vv6::unique_func<int(int)> h(std::move(g));
+    BOOST_TEST(h(3) == 4);
+
+    vv6::unique_func<vv6::overload<int(int) const noexcept, int()>> o([](auto... x) noexcept { return (0 + ... + x); });
+    static_assert(noexcept(std::as_const(o)(1)));
+    BOOST_TEST(std::as_const(o)(5) == 5);
+    BOOST_TEST(o() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_copy_func)
+
+static_assert (std::is_copy_constructible_v<vv6::copy_func<int(int)>>);
+static_assert (std::is_copy_assignable_v<vv6::copy_func<int(int) const>>);
+static_assert (std::is_nothrow_move_constructible_v<vv6::copy_func<int(int)>>);
+static_assert (std::is_nothrow_move_assignable_v<vv6::copy_func<int(int)>>);
+
+static_assert (!std::is_constructible_v<vv6::copy_func<void()>, vv6::unique_func<void()>>);
+static_assert (std::is_constructible_v<vv6::unique_func<void()>, vv6::copy_func<void()>&&>);
+static_assert (std::is_constructible_v<vv6::copy_func<int(int)>, vv6::copy_func<int(int) const>&&>);
+
+struct counted
+{
+    static inline int copies = 0;
+    static inline int lived = 0;
+
+    int m_value = 0;
+
+    counted()
+    {
+        ++lived;
+    }
+
+    counted(const counted& other) : m_value(other.m_value)
+    {
+        ++copies;
+        ++lived;
+    }
+
+    counted(counted&& other) noexcept : m_value(other.m_value)
+    {
+        ++lived;
+    }
+
+    ~counted()
+    {
+        --lived;
+    }
+
+    int operator()(int x)
+    {
+        return m_value += x;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    static constexpr F a;
+    vv6::copy_func<int(int) const> f1(a);
+    auto f2 = f1;
+    BOOST_TEST(f1(10) == 52);
+    BOOST_TEST(f2(10) == 52);
+
+    vv6::copy_func<int(int)> f3(f2);
+    BOOST_TEST(f3(10) == 52);
+
+    vv6::copy_func<int(int)> f4(F::f);
+    f3 = f4;
+    BOOST_TEST(f3(1) == 43);
+}
+
+BOOST_AUTO_TEST_CASE(value_semantics)
+{
+    {
+        vv6::copy_func<int(int)> f1{counted()};
+        BOOST_TEST(f1(1) == 1);
+
+        auto f2 = f1;
+        BOOST_TEST(counted::copies == 1);
+        BOOST_TEST(f2(1) == 2);
+        BOOST_TEST(f1(10) == 11);
+
+        f1 = f2;
+        BOOST_TEST(counted::copies == 2);
+        BOOST_TEST(f1(1) == 3);
+        BOOST_TEST(counted::lived == 2);
+
+        vv6::unique_func<int(int)> u(std::move(f1));
+        BOOST_TEST(!f1);
+        BOOST_TEST(u(1) == 4);
+    }
+    BOOST_TEST(counted::lived == 0);
+}
+
+BOOST_AUTO_TEST_CASE(external)
+{
+    struct G : F
+    {
+        char pad[2 * sizeof(std::max_align_t)] = {};
+        std::vector<int> v{1, 2, 3};
+    } g;
+    static_assert(!vv6::uf_details::is_inplace<G>);
+
+    vv6::copy_func<int(int) const> f1(g);
+    auto f2 = f1;
+    BOOST_TEST(f2(0) == 42);
+
+    using test_unique_func::allocator;
+    using test_unique_func::allocated;
+    using test_unique_func::deallocated;
+    allocated = deallocated = 0;
+    {
+        vv6::copy_func<int(int) const> f3(std::allocator_arg, allocator<void>(), g);
+        auto block = allocated;
+        BOOST_TEST(block > 0);
+
+        auto f4 = f3;
+        BOOST_TEST(f4(0) == 42);
+        BOOST_TEST(allocated == 2 * block);
+    }
+    BOOST_TEST(allocated == deallocated);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_inplace_func)
+
+static_assert (std::is_nothrow_move_constructible_v<vv6::inplace_func<int(int)>>);
+static_assert (std::is_nothrow_move_assignable_v<vv6::inplace_func<int(int)>>);
+static_assert (!std::is_copy_constructible_v<vv6::inplace_func<int(int)>>);
+static_assert (std::is_nothrow_constructible_v<vv6::inplace_func<int(int)>, const F&>);
+
+static_assert (std::is_constructible_v<vv6::inplace_func<int(int), 64>, vv6::inplace_func<int(int) const, 32>&&>);
+static_assert (!std::is_constructible_v<vv6::inplace_func<int(int), 64>, vv6::unique_func<int(int)>&&>);
+static_assert (std::is_constructible_v<vv6::unique_func<int(int)>, vv6::inplace_func<int(int), 32>&&>);
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    static constexpr F a;
+    vv6::inplace_func<int(int) const, sizeof(F), alignof(F)> f1(a);
+    BOOST_TEST(f1(10) == 52);
+    static_assert(sizeof(f1) == 2 * sizeof(void*) + sizeof(void*));
+
+    vv6::inplace_func<int(int), 64> f2(std::move(f1));
+    BOOST_TEST(!f1);
+    BOOST_TEST(f2(10) == 52);
+
+    vv6::unique_func<int(int)> f3(std::move(f2));
+    BOOST_TEST(!f2);
+    BOOST_TEST(f3(10) == 52);
+}
+
+BOOST_AUTO_TEST_CASE(large)
+{
+    int lived = 0;
+    struct A
+    {
+        int *m_a;
+        char m_pad[200] = {};
+
+        A(int *a) : m_a(a)
+        {
+            ++(*m_a);
+        }
+
+        A(A&& other) noexcept : m_a(other.m_a)
+        {
+            ++(*m_a);
+        }
+
+        ~A()
+        {
+            --(*m_a);
+        }
+
+        int operator()(int x)
+        {
+            return x + m_pad[0];
+        }
+    };
+
+    {
+        vv6::inplace_func<int(int), sizeof(A)> f(std::in_place_type<A>, &lived);
+        BOOST_TEST(lived == 1);
+        auto g = std::move(f);
+        BOOST_TEST(lived == 1);
+        BOOST_TEST(g(1) == 1);
+        f = std::move(g);
+        BOOST_TEST(f(2) == 2);
+    }
+    BOOST_TEST(lived == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_func_queue)
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    vv6::func_queue<void(int&)> q(3);
+    BOOST_TEST(q.capacity() == 4u);
+
+    auto p = std::make_unique<int>(10);
+    BOOST_TEST(q.try_push([p = std::move(p)](int& x) { x += *p; }));
+    BOOST_TEST(q.try_push(vv6::unique_func<void(int&)>([](int& x) { x *= 2; })));
+    BOOST_TEST(q.try_push([](int& x) { x -= 1; }));
+    BOOST_TEST(q.try_push([](int& x) { x -= 1; }));
+    BOOST_TEST(!q.try_push([](int&) {}));
+    BOOST_TEST(q.size() == 4u);
+
+    int x = 1;
+    BOOST_TEST(q.try_invoke(x));
+    BOOST_TEST(x == 11);
+    BOOST_TEST(q.try_invoke(x));
+    BOOST_TEST(x == 22);
+
+    vv6::unique_func<void(int&)> f;
+    BOOST_TEST(q.try_pop(f));
+    f(x);
+    BOOST_TEST(x == 21);
+    BOOST_TEST(q.try_invoke(x));
+    BOOST_TEST(x == 20);
+    BOOST_TEST(!q.try_invoke(x));
+    BOOST_TEST(!q.try_pop(f));
+}
+
+BOOST_AUTO_TEST_CASE(throwing)
+{
+    struct A
+    {
+        A(int)
+        {
+            throw std::runtime_error("A");
+        }
+
+        void operator()() {}
+    };
+
+    vv6::func_queue<void()> q(2);
+    int calls = 0;
+    BOOST_CHECK_THROW(q.try_emplace<A>(1), std::runtime_error);
+    BOOST_TEST(q.try_push([&] { ++calls; }));
+    BOOST_TEST(q.try_invoke());
+    BOOST_TEST(calls == 1);
+    BOOST_TEST(!q.try_invoke());
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+    constexpr int producers = 4, consumers = 4, per_producer = 20000;
+    vv6::func_queue<void()> q(64);
+    std::atomic<long> sum{0};
+    std::atomic<int> done{0};
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < producers; ++i)
+    {
+        threads.emplace_back([&]
+        {
+            for(int j = 1; j <= per_producer; ++j)
+            {
+                while(!q.try_push([&sum, j] { sum.fetch_add(j, std::memory_order_relaxed); }))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(int i = 0; i < consumers; ++i)
+    {
+        threads.emplace_back([&]
+        {
+            while(done.load() < producers * per_producer)
+            {
+                if(q.try_invoke())
+                {
+                    done.fetch_add(1);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+    BOOST_TEST(sum.load() == long(producers) * per_producer * (per_producer + 1) / 2);
+    BOOST_TEST(q.size() == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_thread_pool)
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    std::atomic<int> count{0};
+    {
+        vv6::thread_pool pool(4);
+        BOOST_TEST(pool.size() == 4u);
+        BOOST_TEST(!pool.running_in_this_thread());
+        auto p = std::make_unique<int>(1);
+        pool.post([&count, p = std::move(p)] { count += *p; });
+        for(int i = 0; i < 1000; ++i)
+        {
+            pool.post([&] { ++count; });
+        }
+        pool.dispatch([&] { ++count; });
+        pool.defer([&] { ++count; });
+    }
+    BOOST_TEST(count.load() == 1003);
+}
+
+BOOST_AUTO_TEST_CASE(spawn)
+{
+    struct node
+    {
+        vv6::thread_pool* m_pool;
+        std::atomic<int>* m_leaves;
+        int m_depth;
+
+        void operator()() const
+        {
+            if(m_depth == 0)
+            {
+                ++*m_leaves;
+                return;
+            }
+            m_pool->post(node{m_pool, m_leaves, m_depth - 1});
+            m_pool->defer(node{m_pool, m_leaves, m_depth - 1});
+        }
+    };
+
+    std::atomic<int> leaves{0};
+    bool inline_dispatch = false;
+    {
+        //a tiny deque to exercise the overflow into the shared queue
+        vv6::thread_pool pool(3, 4);
+        pool.post(node{&pool, &leaves, 12});
+        pool.post([&]
+        {
+            bool outer = true;
+            pool.dispatch([&] { inline_dispatch = outer && pool.running_in_this_thread(); });
+            outer = false;
+        });
+    }
+    BOOST_TEST(leaves.load() == 1 << 12);
+    BOOST_TEST(inline_dispatch);
+}
+
+//the workers fall asleep between the rounds, every result must come while the pool is alive
+BOOST_AUTO_TEST_CASE(wake_up)
+{
+    vv6::thread_pool pool(2);
+    for(int i = 0; i < 5000; ++i)
+    {
+        std::promise<int> p;
+        auto f = p.get_future();
+        //a worker which is still busy when the next post looks for sleepers
+        pool.post([i]
+        {
+            auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(i % 3 * 20);
+            while(std::chrono::steady_clock::now() < until)
+            {
+
+            }
+        });
+        pool.post([&p, i] { p.set_value(i); });
+        BOOST_REQUIRE(f.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+        BOOST_TEST(f.get() == i);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_func_batch)
+
+struct event
+{
+    int value;
+};
+
+struct adder
+{
+    int* m_sum;
+    int m_factor;
+
+    void operator()(const event& e) const
+    {
+        *m_sum += e.value * m_factor;
+    }
+};
+
+struct counter
+{
+    int m_calls = 0;
+
+    void operator()(const event&)
+    {
+        ++m_calls;
+    }
+};
+
+int free_calls = 0;
+
+void free_handler(const event&)
+{
+    ++free_calls;
+}
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    int sum = 0;
+    std::vector<adder> adders;
+    for(int i = 1; i <= 10; ++i)
+    {
+        adders.push_back({&sum, i});
+    }
+    counter c1, c2;
+
+    vv6::func_batch<void(const event&)> batch;
+    for(std::size_t i = 0; i < adders.size(); ++i)
+    {
+        if(i % 2)
+        {
+            batch.add(adders[i]);
+        }
+        else
+        {
+            batch.add(vv6::func_view<void(const event&)>(adders[i]));
+        }
+    }
+    batch.add(vv6::use_non_const, c1);
+    batch.add(vv6::func_view<void(const event&)>(vv6::use_non_const, c2));
+    batch.add(free_handler);
+    BOOST_TEST(batch.size() == 13u);
+    BOOST_TEST(batch.groups() == 3u);
+
+    batch.invoke_all(event{2});
+    BOOST_TEST(sum == 110);
+    BOOST_TEST(c1.m_calls == 1);
+    BOOST_TEST(c2.m_calls == 1);
+    BOOST_TEST(free_calls == 1);
+
+    BOOST_TEST(batch.remove(adders[0]));
+    BOOST_TEST(batch.remove(vv6::use_non_const, c2));
+    BOOST_TEST(!batch.remove(vv6::use_non_const, c2));
+    BOOST_TEST(batch.remove(free_handler));
+    BOOST_TEST(batch.size() == 10u);
+    BOOST_TEST(batch.groups() == 2u);
+
+    sum = 0;
+    batch.invoke_all(event{1});
+    BOOST_TEST(sum == 54);
+    BOOST_TEST(c1.m_calls == 2);
+    BOOST_TEST(c2.m_calls == 1);
+    BOOST_TEST(free_calls == 1);
+
+    batch.add(free_handler);
+    BOOST_TEST(batch.groups() == 3u);
+    batch.invoke_all(event{1});
+    BOOST_TEST(free_calls == 2);
+
+    batch.clear();
+    BOOST_TEST(batch.empty());
+}
+
+BOOST_AUTO_TEST_CASE(values)
+{
+    std::string seen;
+    auto f = [&](std::string s) { seen += s; };
+    vv6::func_batch<void(std::string)> batch;
+    batch.add(f);
+    batch.add(f);
+    batch.invoke_all("ab");
+    BOOST_TEST(seen == "abab");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_func_vector)
+
+//points into itself, so it has to be moved by its constructor
+struct self_referencing
+{
+    std::vector<int>* m_out;
+    int m_value;
+    int* m_self = &m_value;
+
+    self_referencing(std::vector<int>* out, int value) noexcept :
+        m_out(out), m_value(value)
+    {
+
+    }
+
+    self_referencing(self_referencing&& other) noexcept :
+        m_out(other.m_out), m_value(other.m_value)
+    {
+
+    }
+
+    void operator()(int x)
+    {
+        m_out->push_back(*m_self + x);
+    }
+};
+
+struct alignas(16) aligned
+{
+    std::vector<int>* m_out;
+
+    void operator()(int x) const
+    {
+        BOOST_TEST(reinterpret_cast<std::uintptr_t>(this) % 16 == 0u);
+        m_out->push_back(x);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    std::vector<int> out;
+    auto counted = std::make_shared<int>(0);
+    {
+        vv6::func_vector<void(int)> v;
+        BOOST_TEST(v.empty());
+        v.invoke_all(0);
+        for(int i = 0; i < 100; ++i)
+        {
+            switch(i % 4)
+            {
+            case 0: v.push_back([&out, i](int x) { out.push_back(i + x); }); break;
+            case 1: v.emplace_back<self_referencing>(&out, i); break;
+            case 2: v.push_back(aligned{&out}); break;
+            default: v.push_back([&out, counted, pad = std::array<char, 200>{}](int) { out.push_back(pad[0] - 1); }); break;
+            }
+        }
+        BOOST_TEST(v.size() == 100u);
+        BOOST_TEST(counted.use_count() == 26);
+        v.invoke_all(1000);
+        BOOST_TEST(out.size() == 100u);
+        for(int i = 0; i < 100; ++i)
+        {
+            int expected[] = {i + 1000, i + 1000, 1000, -1};
+            BOOST_TEST(out[i] == expected[i % 4]);
+        }
+
+        auto w = std::move(v);
+        BOOST_TEST(v.empty());
+        BOOST_TEST(w.size() == 100u);
+        out.clear();
+        w.invoke_all(0);
+        BOOST_TEST(out.size() == 100u);
+
+        auto capacity = w.capacity();
+        w.clear();
+        BOOST_TEST(w.empty());
+        BOOST_TEST(w.bytes() == 0u);
+        BOOST_TEST(w.capacity() == capacity);
+        BOOST_TEST(counted.use_count() == 1);
+
+        w.push_back([&out, counted](int x) { out.push_back(x); });
+        v = std::move(w);
+        BOOST_TEST(counted.use_count() == 2);
+    }
+    BOOST_TEST(counted.use_count() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(packed)
+{
+    int sum = 0;
+    vv6::func_vector<void() const noexcept> v;
+    v.reserve(1024);
+    auto data = v.capacity();
+    for(int i = 0; i < 32; ++i)
+    {
+        v.push_back([&sum]() noexcept { ++sum; });
+    }
+    //two pointers and two offsets in the header, then the captured pointer
+    BOOST_TEST(v.bytes() == 32 * (3 * sizeof(void*) + 8));
+    BOOST_TEST(v.capacity() == data);
+    static_assert(noexcept(v.invoke_all()));
+    v.invoke_all();
+    BOOST_TEST(sum == 32);
+
+    vv6::func_vector<int(int)> counters;
+    int calls = 0;
+    counters.push_back([&calls, n = 0](int x) mutable { calls += ++n; return x; });
+    counters.invoke_all(1);
+    counters.invoke_all(1);
+    BOOST_TEST(calls == 3);
+}
+
+BOOST_AUTO_TEST_CASE(reentrant)
+{
+    //adds enough to make the buffer grow a few times, then uses its own state
+    struct spawner
+    {
+        vv6::func_vector<void(int)>* m_vector;
+        std::vector<int>* m_out;
+        std::string m_name = std::string(40, 'x');
+
+        void operator()(int x)
+        {
+            if(x == 0)
+            {
+                for(int i = 0; i < 50; ++i)
+                {
+                    m_vector->emplace_back<self_referencing>(m_out, i);
+                }
+            }
+            m_out->push_back(int(m_name.size()) + x);
+        }
+    };
+
+    std::vector<int> out;
+    vv6::func_vector<void(int)> v;
+    v.push_back(spawner{&v, &out});
+    v.emplace_back<self_referencing>(&out, 7);
+    auto capacity = v.capacity();
+    v.invoke_all(0);
+    //what was added is not called by the walk which added it
+    BOOST_TEST((out == std::vector<int>{40, 7}));
+    BOOST_TEST(v.size() == 52u);
+    BOOST_TEST(v.capacity() > capacity);
+
+    out.clear();
+    v.invoke_all(1000);
+    BOOST_TEST(out.size() == 52u);
+    BOOST_TEST(out[0] == 1040);
+    BOOST_TEST(out[1] == 1007);
+    for(int i = 0; i < 50; ++i)
+    {
+        BOOST_TEST(out[i + 2] == 1000 + i);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_pipeline)
+
+template <typename Fs, typename = void>
+struct can_compose_view_impl : std::false_type {};
+
+template <typename... Fs>
+struct can_compose_view_impl<std::tuple<Fs...>, std::void_t<decltype(vv6::compose_view<int>(std::declval<Fs>()...))>> :
+        std::true_type {};
+
+template <typename... Fs>
+using can_compose_view = can_compose_view_impl<std::tuple<Fs...>>;
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    auto parse = [](std::string_view s) { return int(s.size()); };
+    auto twice = [](int x) { return 2 * x; };
+    auto show = [](int x) { return std::to_string(x); };
+
+    auto p = vv6::compose(parse, twice, show);
+    static_assert(decltype(p)::size() == 3);
+    static_assert(std::is_empty_v<decltype(parse)> && sizeof(p) < vv6::default_capacity);
+    static_assert(std::is_same_v<decltype(p), decltype(vv6::compose(vv6::compose(parse), twice).then(show))>);
+    static_assert(std::is_same_v<decltype(p), decltype(vv6::compose(parse, vv6::compose(twice, show)))>);
+    BOOST_TEST(p(std::string_view("abc")) == "6");
+
+    //a single wrapper, the stages are not wrapped one by one
+    vv6::unique_func<std::string(std::string_view)> f(std::move(p));
+    BOOST_TEST(f(std::string_view("abcd")) == "8");
+    static_assert(!std::is_constructible_v<vv6::unique_func<std::string(int)>, decltype(p)>);
+
+    //a stage which returns nothing is followed by one which takes nothing
+    int seen = 0;
+    auto q = vv6::compose(twice, [&](int x) { seen = x; }, [&]() { return seen + 1; });
+    BOOST_TEST(q(20) == 41);
+    BOOST_TEST(seen == 40);
+
+    auto inc = [](int x) noexcept { return x + 1; };
+    vv6::unique_func<int(int) noexcept> n(vv6::compose(inc, inc, inc));
+    BOOST_TEST(n(0) == 3);
+    static_assert(!std::is_nothrow_invocable_v<decltype(vv6::compose(inc, twice)), int>);
+
+    //wrappers are stages as well
+    vv6::unique_func<int(int)> a(twice);
+    auto r = vv6::compose(std::move(a), inc).then(show);
+    BOOST_TEST(!a);
+    BOOST_TEST(r(5) == "11");
+}
+
+BOOST_AUTO_TEST_CASE(views)
+{
+    int offset = 3;
+    auto add = [&offset](int x) { return x + offset; };
+    auto twice = [](int x) { return 2 * x; };
+
+    auto v = vv6::compose_view<int>(add, twice, add);
+    static_assert(std::is_same_v<decltype(v), vv6::pipeline<vv6::func_view<int(int)>, vv6::func_view<int(int)>,
+                                                            vv6::func_view<int(int)>>>);
+    static_assert(std::is_trivially_copy_constructible_v<decltype(v)> && std::is_trivially_destructible_v<decltype(v)>);
+    static_assert(sizeof(v) == 3 * sizeof(vv6::func_view<int(int)>));
+    BOOST_TEST(v(1) == 11);
+    offset = 0;
+    auto w = v;
+    BOOST_TEST(w(1) == 2);
+
+    vv6::func_view<int(int)> view(v);
+    BOOST_TEST(view(2) == 4);
+
+    auto length = [](std::string_view s) { return s.size(); };
+    auto u = vv6::compose_view<std::string_view>(length, twice);
+    BOOST_TEST(u(std::string_view("abc")) == 6);
+
+    //temporaries are refused, lvalues among them do not help
+    static_assert(can_compose_view<decltype(add)&, decltype(twice)&>::value);
+    static_assert(can_compose_view<const decltype(add)&>::value);
+    static_assert(!can_compose_view<decltype(add)>::value);
+    static_assert(!can_compose_view<decltype(add)&, decltype(twice)>::value);
+    static_assert(!can_compose_view<const decltype(add)&&>::value);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_timer_wheel)
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    vv6::timer_wheel<> w;
+    std::vector<int> fired;
+    w.schedule(3, [&]() { fired.push_back(3); });
+    w.schedule(1, [&]() { fired.push_back(1); });
+    auto h = w.schedule(2, [&]() { fired.push_back(2); });
+    w.schedule(0, [&]() { fired.push_back(0); });
+    BOOST_TEST(w.size() == 4u);
+
+    BOOST_TEST(w.cancel(h));
+    BOOST_TEST(!w.cancel(h));
+    BOOST_TEST(!w.cancel({}));
+    BOOST_TEST(w.size() == 3u);
+
+    BOOST_TEST(w.advance(1) == 2u);
+    BOOST_TEST((fired == std::vector<int>{1, 0}));
+    BOOST_TEST(w.advance(5) == 1u);
+    BOOST_TEST((fired == std::vector<int>{1, 0, 3}));
+    BOOST_TEST(w.empty());
+    BOOST_TEST(w.now() == 6u);
+
+    //the node of h is reused, the old handle does not reach the new timer
+    auto h2 = w.schedule(1, vv6::unique_func<void()>([&]() { fired.push_back(4); }));
+    BOOST_TEST(!w.cancel(h));
+    BOOST_TEST(w.advance(1) == 1u);
+    BOOST_TEST(!w.cancel(h2));
+}
+
+BOOST_AUTO_TEST_CASE(levels)
+{
+    vv6::timer_wheel<> w(1000);
+    std::vector<std::uint64_t> delays{1, 255, 256, 257, 65535, 65536, 70000, 1 << 24, (1 << 24) + 3,
+                                      (std::uint64_t(1) << 32) + 5, 300, 5000};
+    std::vector<std::uint64_t> at;
+    for(auto d : delays)
+    {
+        w.schedule(d, [&at, &w, d]()
+        {
+            BOOST_TEST(w.now() == 1000 + d);
+            at.push_back(d);
+        });
+    }
+    std::size_t fired = 0;
+    while(!w.empty())
+    {
+        fired += w.advance(1 << 20);
+    }
+    BOOST_TEST(fired == delays.size());
+    std::sort(delays.begin(), delays.end());
+    BOOST_TEST(at == delays);
+}
+
+BOOST_AUTO_TEST_CASE(far)
+{
+    //the deadline saturates instead of wrapping around into the past
+    vv6::timer_wheel<> w(100);
+    int fired = 0;
+    w.schedule(UINT64_MAX, [&fired]() { ++fired; });
+    BOOST_TEST(w.advance(std::uint64_t(1) << 40) == 0u);
+    BOOST_TEST(fired == 0);
+    BOOST_TEST(w.size() == 1u);
+    BOOST_TEST(w.now() == 100 + (std::uint64_t(1) << 40));
+
+    //so does time
+    vv6::timer_wheel<> end(UINT64_MAX - 10);
+    end.schedule(5, [&fired]() { ++fired; });
+    BOOST_TEST(end.advance(100) == 1u);
+    BOOST_TEST(end.now() == UINT64_MAX);
+    BOOST_TEST(fired == 1);
+}
+
+BOOST_AUTO_TEST_CASE(reentrant)
+{
+    vv6::timer_wheel<> w;
+    auto counter = std::make_shared<int>(0);
+    int fired = 0;
+    vv6::timer_wheel<>::handle later;
+    //the first one cancels the second, which is due at the same tick, and schedules another one
+    w.schedule(10, [&]()
+    {
+        ++fired;
+        BOOST_TEST(w.cancel(later));
+        w.schedule(10, [&]() { ++fired; });
+    });
+    later = w.schedule(10, [&, counter]() { fired += 100; });
+    BOOST_TEST(counter.use_count() == 2);
+    BOOST_TEST(w.advance(10) == 1u);
+    BOOST_TEST(fired == 1);
+    BOOST_TEST(counter.use_count() == 1);
+    BOOST_TEST(w.advance(10) == 1u);
+    BOOST_TEST(fired == 2);
+
+    //a callable which throws stops advance, the others of its tick fire at the next one
+    w.schedule(1, []() { throw std::runtime_error("timer"); });
+    w.schedule(1, [&]() { ++fired; });
+    w.schedule(2, [&, counter]() { ++fired; });
+    BOOST_CHECK_THROW(w.advance(5), std::runtime_error);
+    BOOST_TEST(fired == 2);
+    BOOST_TEST(w.size() == 2u);
+    BOOST_TEST(w.advance(5) == 2u);
+    BOOST_TEST(fired == 4);
+
+    //what is still pending goes with the wheel
+    {
+        vv6::timer_wheel<> w2;
+        w2.schedule(100, [counter]() {});
+        BOOST_TEST(counter.use_count() == 2);
+    }
+    BOOST_TEST(counter.use_count() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(test_signal)
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    vv6::signal<void(int, const std::string&)> sig;
+    BOOST_TEST(sig.empty());
+    sig(1, "nobody");
+
+    int sum = 0;
+    std::string last;
+    auto p = std::make_unique<int>(10);
+    auto c1 = sig.connect([&sum, p = std::move(p)](int x, const std::string&) { sum += x * *p; });
+    auto c2 = sig.connect([&](int, const std::string& s) { last = s; });
+    BOOST_TEST(sig.size() == 2u);
+    BOOST_TEST(c1.connected());
+
+    sig(2, "two");
+    BOOST_TEST(sum == 20);
+    BOOST_TEST(last == "two");
+
+    BOOST_TEST(c1.disconnect());
+    BOOST_TEST(!c1.connected());
+    BOOST_TEST(!c1.disconnect());
+    sig.emit(3, "three");
+    BOOST_TEST(sum == 20);
+    BOOST_TEST(last == "three");
+
+    {
+        vv6::scoped_connection sc = sig.connect([&](int x, const std::string&) { sum += x; });
+        sig(1, "one");
+        BOOST_TEST(sum == 21);
+    }
+    BOOST_TEST(sig.size() == 1u);
+
+    sig.disconnect_all();
+    BOOST_TEST(!c2.connected());
+    BOOST_TEST(sig.empty());
+
+    vv6::connection orphan;
+    {
+        vv6::signal<void()> gone;
+        orphan = gone.connect([] {});
+    }
+    BOOST_TEST(!orphan.connected());
+    BOOST_TEST(!orphan.disconnect());
+}
+
+BOOST_AUTO_TEST_CASE(reentrant)
+{
+    vv6::signal<void(int&)> sig;
+    vv6::connection self, other;
+    int calls = 0;
+
+    //disconnects itself and the next slot, and connects a new one which only sees later emissions
+    self = sig.connect([&](int& x)
+    {
+        ++calls;
+        self.disconnect();
+        other.disconnect();
+        sig.connect([](int& y) { y += 100; });
+        x += 1;
+    });
+    other = sig.connect([](int& x) { x += 10; });
+
+    int x = 0;
+    sig(x);
+    BOOST_TEST(x == 1);
+    sig(x);
+    BOOST_TEST(x == 101);
+    BOOST_TEST(calls == 1);
+    BOOST_TEST(sig.size() == 1u);
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+    vv6::signal<void(std::atomic<long>&)> sig;
+    sig.connect([](std::atomic<long>& n) { ++n; });
+    std::atomic<bool> stop{false};
+    std::atomic<long> calls{0};
+    std::atomic<int> started{0};
+
+    std::vector<std::thread> emitters;
+    for(int i = 0; i < 3; ++i)
+    {
+        emitters.emplace_back([&]
+        {
+            sig(calls);
+            ++started;
+            while(!stop.load())
+            {
+                sig(calls);
+            }
+        });
+    }
+    for(int i = 0; i < 2000 || started.load() < 3; ++i)
+    {
+        auto c = sig.connect([v = std::vector<int>(4, i)](std::atomic<long>& n) { n += v[0] - v[3]; });
+        c.disconnect();
+    }
+    stop = true;
+    for(auto& t : emitters)
+    {
+        t.join();
+    }
+    BOOST_TEST(sig.size() == 1u);
+    BOOST_TEST(calls.load() >= 3);
+}
+
+BOOST_AUTO_TEST_CASE(grace_period)
+{
+    struct counted
+    {
+        std::atomic<int>* m_alive;
+
+        explicit counted(std::atomic<int>* alive) :
+            m_alive(alive)
+        {
+            ++*m_alive;
+        }
+
+        counted(const counted& other) :
+            m_alive(other.m_alive)
+        {
+            ++*m_alive;
+        }
+
+        ~counted()
+        {
+            --*m_alive;
+        }
+
+        void operator()() const
+        {
+
+        }
+    };
+
+    //the first slot holds each emission until it is released
+    std::array<std::promise<void>, 2> entered, release;
+    std::atomic<int> calls{0};
+    vv6::signal<void()> sig;
+    sig.connect([&]
+    {
+        auto i = calls++;
+        entered[i].set_value();
+        release[i].get_future().wait();
+    });
+
+    std::atomic<int> alive{0};
+    auto c1 = sig.connect(counted(&alive));
+    std::thread t1([&] { sig(); });
+    entered[0].get_future().wait();
+    c1.disconnect();
+    auto c2 = sig.connect(counted(&alive));
+    std::thread t2([&] { sig(); });
+    entered[1].get_future().wait();
+    BOOST_TEST(alive.load() == 2);
+
+    //the emissions overlap, the first slot is freed once the emission which could see it is gone
+    release[0].set_value();
+    t1.join();
+    c2.disconnect();
+    BOOST_TEST(alive.load() == 1);
+
+    release[1].set_value();
+    t2.join();
+    sig.disconnect_all();
+    BOOST_TEST(alive.load() == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#ifdef __cpp_impl_coroutine
+
+BOOST_AUTO_TEST_SUITE(test_task)
+
+vv6::task<int> add(int a, int b)
+{
+    co_return a + b;
+}
+
+vv6::task<std::string> concat(int n)
+{
+    std::string s;
+    for(int i = 0; i < n; ++i)
+    {
+        s += std::to_string(co_await add(i, 1));
+    }
+    co_return s;
+}
+
+vv6::task<> fail()
+{
+    throw std::runtime_error("fail");
+    co_return;
+}
+
+vv6::task<bool> catches()
+{
+    try
+    {
+        co_await fail();
+    }
+    catch(const std::runtime_error&)
+    {
+        co_return true;
+    }
+    co_return false;
+}
+
+BOOST_AUTO_TEST_CASE(test1)
+{
+    std::string result;
+    concat(3).start([&](std::string s) { result = std::move(s); });
+    BOOST_TEST(result == "123");
+
+    bool caught = false;
+    catches().start([&](bool b) { caught = b; });
+    BOOST_TEST(caught);
+
+    auto t = add(1, 2);
+    BOOST_TEST(!t.done());
+    int value = 0;
+    [](vv6::task<int>& t, int& value) -> vv6::task<>
+    {
+        value = co_await t;
+    }(t, value).start();
+    BOOST_TEST(t.done());
+    BOOST_TEST(value == 3);
+}
+
+BOOST_AUTO_TEST_CASE(callbacks)
+{
+    //completes later, as an asynchronous api would
+    vv6::unique_func<void(int)> pending;
+    auto read = [&]() -> vv6::task<int>
+    {
+        int a = co_await vv6::await_callback<int>([&](vv6::unique_func<void(int)> done) { pending = std::move(done); });
+        //completes right away
+        int b = co_await vv6::await_callback<int>([](vv6::unique_func<void(int)> done) { done(10); });
+        co_await vv6::await_callback([](vv6::unique_func<void()> done) { done(); });
+        co_return a + b;
+    };
+
+    int result = 0;
+    read().start([&](int r) { result = r; });
+    BOOST_TEST(result == 0);
+    BOOST_TEST(static_cast<bool>(pending));
+    auto done = std::move(pending);
+    done(5);
+    BOOST_TEST(result == 15);
+}
+
+BOOST_AUTO_TEST_CASE(synchronous)
+{
+    //the operation returns before the coroutine goes on, and completions in a row do not nest
+    auto run = []() -> vv6::task<long>
+    {
+        bool returned = false;
+        co_await vv6::await_callback([&](vv6::unique_func<void()> done) { done(); returned = true; });
+        long sum = returned;
+        for(int i = 0; i < 1000000; ++i)
+        {
+            sum += co_await vv6::await_callback<int>([](vv6::unique_func<void(int)> done) { done(1); });
+        }
+        co_return sum;
+    };
+
+    long result = 0;
+    run().start([&](long r) { result = r; });
+    BOOST_TEST(result == 1000001);
+}
+
+//a lambda would be gone before the pool runs the rest of the coroutine
+vv6::task<> hop(vv6::thread_pool& pool, std::atomic<int>& count, std::atomic<bool>& on_pool)
+{
+    co_await vv6::resume_on(pool);
+    on_pool = on_pool && pool.running_in_this_thread();
+    ++count;
+}
+
+struct inline_executor
+{
+    std::vector<vv6::unique_func<void()>> m_tasks;
+
+    void post(vv6::unique_func<void()> f)
+    {
+        m_tasks.push_back(std::move(f));
+    }
+};
+
+BOOST_AUTO_TEST_CASE(executor)
+{
+    inline_executor ex;
+    auto queued = [&]() -> vv6::task<int>
+    {
+        co_await vv6::resume_on(ex);
+        co_return 1;
+    };
+    int result = 0;
+    queued().start([&](int r) { result = r; });
+    BOOST_TEST(ex.m_tasks.size() == 1u);
+    ex.m_tasks[0]();
+    BOOST_TEST(result == 1);
+
+    std::atomic<int> count{0};
+    std::atomic<bool> on_pool{true};
+    {
+        vv6::thread_pool pool(2);
+        for(int i = 0; i < 100; ++i)
+        {
+            hop(pool, count, on_pool).start();
+        }
+    }
+    BOOST_TEST(count.load() == 100);
+    BOOST_TEST(on_pool.load());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif